@@ -46,17 +46,632 @@
 #include <fstream>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <numeric>
 #include <sys/stat.h>
+#include <sys/resource.h>
+
+#include "cdos-experiment.h"
+#include "cdos-sweep.h"
+#include "cdos-phase-map.h"
+#include "cdos-multi-fidelity.h"
+#include "cdos-surrogate.h"
+#include "cdos-sensitivity.h"
+#include "cdos-scheduler.h"
+#include "cdos-job-queue.h"
+#include "cdos-progress.h"
+#include "cdos-topology.h"
+#include "cdos-floor-plan.h"
+#include "cdos-edca.h"
+#include "cdos-cw-control.h"
+#include "cdos-power-tuning.h"
+#include "cdos-channel-plan.h"
+#include "cdos-token-bucket.h"
+#include "cdos-codel.h"
+#include "cdos-detector.h"
+#include "cdos-deployment.h"
+#include "cdos-loss-batch.h"
+#include "cdos-result-ring.h"
+#include "cdos-perf-counters.h"
+#include "cdos-determinism.h"
 
 using namespace ns3;
 
+// All output goes below this folder, next to the athstats traces.
+static std::string OutputPath (std::string name){
+  mkdir("CDoS-6Mbps-adhoc-UDP-building",S_IRWXU | S_IRWXG | S_IRWXO);
+  return "./CDoS-6Mbps-adhoc-UDP-building/" + name;
+}
+
+// Snapshot of the bytes received by every sink, taken at the attack window edges.
+static void RecordRx (std::vector<Ptr<PacketSink> > *sinks, std::vector<uint64_t> *rx){
+  for (size_t i = 0; i < sinks->size (); ++i){
+    (*rx)[i] = (*sinks)[i]->GetTotalRx ();
+  }
+}
+
+/* Work counter and watchdog of a run. The limits are checked every 1024 PHY
+ * events and every 100 ms of simulated time; when one is exceeded the
+ * simulation is stopped after the current event and the partial result is
+ * marked with the name of the limit.
+ */
+struct RunMonitor {
+  uint64_t phyEvents;
+  std::chrono::steady_clock::time_point begin;
+  const ExperimentConfig *config;
+  std::string truncated;
+};
+
+static void CheckLimits (RunMonitor *monitor){
+  const ExperimentConfig &c = *monitor->config;
+  if (monitor->truncated != "none"){
+    return;
+  }
+  if (c.maxWallTime > 0
+      && std::chrono::duration<double> (std::chrono::steady_clock::now () - monitor->begin).count () > c.maxWallTime){
+    monitor->truncated = "wall";
+  }else if (c.maxEvents > 0 && monitor->phyEvents > c.maxEvents){
+    monitor->truncated = "events";
+  }else if (c.maxRssMb > 0){
+    struct rusage usage;
+    if (getrusage (RUSAGE_SELF, &usage) == 0 && usage.ru_maxrss / 1024.0 > c.maxRssMb){
+      monitor->truncated = "rss";
+    }
+  }
+  if (monitor->truncated != "none"){
+    Simulator::Stop ();
+  }
+}
+
+static void CountPhyEvent (RunMonitor *monitor, Ptr<const Packet> packet){
+  if ((++monitor->phyEvents & 1023) == 0){
+    CheckLimits (monitor);
+  }
+}
+
+// One MAC or PHY trace source of one node, feeding the event trace of the determinism checks
+struct EventTap {
+  EventTrace *trace;
+  uint32_t node;
+  uint32_t kind;
+};
+
+static void TapPacket (EventTap *tap, Ptr<const Packet> packet){
+  TraceEvent e = {Simulator::Now ().GetNanoSeconds (), tap->node, tap->kind, packet->GetSize ()};
+  tap->trace->Record (e);
+}
+
+static void TapFailure (EventTap *tap, Mac48Address address){
+  TraceEvent e = {Simulator::Now ().GetNanoSeconds (), tap->node, tap->kind, 0};
+  tap->trace->Record (e);
+}
+
+static void CountSentPacket (uint64_t *packets, Ptr<const Packet> packet){
+  ++*packets;
+}
+
+static void WatchdogTick (RunMonitor *monitor){
+  CheckLimits (monitor);
+  Simulator::Schedule (MilliSeconds (100), &WatchdogTick, monitor);
+}
+
+// State of the periodic progress report of a run.
+struct ProgressState {
+  ProgressPublisher publisher;
+  std::string label;
+  double interval;
+  double duration;
+  std::vector<Ptr<PacketSink> > *sinks;
+  uint64_t *phyEvents;
+  std::vector<uint64_t> lastRx;
+  uint64_t lastEvents;
+  double lastSim;
+  std::chrono::steady_clock::time_point lastWall;
+};
+
+static void ReportProgress (ProgressState *state){
+  double now = Simulator::Now ().GetSeconds ();
+  if (state->publisher.IsListening ()){
+    std::chrono::steady_clock::time_point wall = std::chrono::steady_clock::now ();
+    double dt = std::chrono::duration<double> (wall - state->lastWall).count ();
+    double rate = dt > 0 ? (now - state->lastSim) / dt : 0;
+    std::ostringstream line;
+    line << "worker=" << getpid () << " run=" << state->label << " t=" << now << " of=" << state->duration
+         << " events_per_s=" << (dt > 0 ? (*state->phyEvents - state->lastEvents) / dt : 0)
+         << " eta_s=" << (rate > 0 ? (state->duration - now) / rate : -1) << " thr=";
+    for (size_t i = 0; i < state->sinks->size (); ++i){
+      uint64_t rx = (*state->sinks)[i]->GetTotalRx ();
+      line << (i ? ";" : "") << (now > state->lastSim ? (rx - state->lastRx[i]) * 8 / (now - state->lastSim) / 1e6 : 0);
+    }
+    state->publisher.Publish (line.str ());
+    state->lastWall = wall;
+  }
+  // keep the baselines current so the first report after a listener appears is right
+  for (size_t i = 0; i < state->sinks->size (); ++i){
+    state->lastRx[i] = (*state->sinks)[i]->GetTotalRx ();
+  }
+  state->lastEvents = *state->phyEvents;
+  if (!state->publisher.IsListening ()){
+    state->lastWall = std::chrono::steady_clock::now ();
+  }
+  state->lastSim = now;
+  Simulator::Schedule (Seconds (state->interval), &ReportProgress, state);
+}
+
+// Transmission statistics and optional contention-window controller of one sender.
+struct SenderState {
+  uint64_t attempts, failures;
+  IdleSense *controller;
+  Ptr<Object> dcf;     // DcaTxop, or BE_EdcaTxopN with the QoS MAC
+  double slot, difs;   // s
+};
+
+static void CountAttempt (SenderState *sender, Ptr<const Packet> packet){
+  sender->attempts++;
+}
+
+static void CountFailure (SenderState *sender, Mac48Address address){
+  sender->failures++;
+}
+
+// Idle periods end with a transmission; those shorter than DIFS are gaps inside a frame exchange.
+static void ObservePhyState (SenderState *sender, Time start, Time duration, WifiPhy::State state){
+  if (state != WifiPhy::IDLE || duration.GetSeconds () < sender->difs){
+    return;
+  }
+  if (sender->controller->Observe ((duration.GetSeconds () - sender->difs) / sender->slot)){
+    sender->dcf->SetAttribute ("MinCw", UintegerValue (sender->controller->GetWindow ()));
+    sender->dcf->SetAttribute ("MaxCw", UintegerValue (sender->controller->GetWindow ()));
+  }
+}
+
+// MAC queue of the device under a /NodeList/<n>/DeviceList/<d>/$ns3::WifiNetDevice/ path.
+static Ptr<WifiMacQueue> LookupMacQueue (const std::string &path, bool qos){
+  Config::MatchContainer txop = Config::LookupMatches (path + "Mac/$ns3::RegularWifiMac/" + (qos ? "BE_EdcaTxopN" : "DcaTxop"));
+  return qos ? DynamicCast<EdcaTxopN> (txop.Get (0))->GetEdcaQueue () : DynamicCast<DcaTxop> (txop.Get (0))->GetQueue ();
+}
+
+// Cascade-onset detector of one sender, fed only with what the sender observes itself.
+struct DetectorState {
+  CascadeDetector detector;
+  Ptr<WifiMacQueue> queue;
+  double window;    // s
+  double prePeak;   // peak statistic before the attack start
+};
+
+static void DetectAttempt (DetectorState *state, Ptr<const Packet> packet){
+  state->detector.OnAttempt ();
+}
+
+static void DetectFailure (DetectorState *state, Mac48Address address){
+  state->detector.OnFailure ();
+}
+
+static void DetectBusy (DetectorState *state, Time start, Time duration, WifiPhy::State phyState){
+  if (phyState == WifiPhy::CCA_BUSY || phyState == WifiPhy::RX){
+    state->detector.OnBusy (duration.GetSeconds ());
+  }
+}
+
+static const double DETECTOR_START = 5;  // s, after the senders' start at 3.1 s
+
+static void DetectWindow (DetectorState *state){
+  state->detector.CloseWindow (Simulator::Now ().GetSeconds (), state->queue->GetSize ());
+  Simulator::Schedule (Seconds (state->window), &DetectWindow, state);
+}
+
+static void DetectAttackStart (DetectorState *state){
+  state->prePeak = state->detector.GetPeak ();
+  state->detector.ResetPeak ();
+}
+
+/* Sender-side airtime shaper and AQM. ns-3.22 has no traffic-control layer
+ * below the sockets, so both wrap the UDP socket of the traffic source: the
+ * source sends through ShapedUdpSocketFactory, and packets wait in a bounded
+ * queue until they conform to the token bucket. With CoDel the queue also
+ * holds packets back while the MAC queue is full, and CoDel drops from its
+ * head by sojourn time.
+ */
+class ShapedSocket;
+
+struct ShaperState {
+  bool limited;                 // token bucket active
+  TokenBucket bucket;
+  bool selfTuning;
+  double gain;
+  double busy;                  // s the PHY was receiving or sensing others in this interval
+  bool aqm;                     // CoDel active
+  CoDel codel;
+  Ptr<WifiMacQueue> macQueue;
+  uint32_t macLimit;            // packets the MAC queue may hold under CoDel
+  ShapedSocket *socket;
+};
+
+static const size_t SHAPER_QUEUE = 100;        // packets
+static const double SHAPER_BURST = 0.005;      // s of airtime
+static const double SHAPER_INTERVAL = 1;       // s between self-tuning steps
+
+class ShapedSocket : public Socket {
+public:
+  ShapedSocket (Ptr<Socket> inner, ShaperState *shaper) : m_inner (inner), m_shaper (shaper) {}
+
+  using Socket::Send;
+  virtual int Send (Ptr<Packet> p, uint32_t flags){
+    if (m_queue.size () >= SHAPER_QUEUE){
+      return p->GetSize ();  // tail drop, like a full device queue
+    }
+    m_queue.push_back (std::make_pair (p, Simulator::Now ().GetSeconds ()));
+    Release ();
+    return p->GetSize ();
+  }
+
+  void Release (){
+    while (!m_queue.empty ()){
+      double now = Simulator::Now ().GetSeconds ();
+      Ptr<Packet> head = m_queue.front ().first;
+      if (m_shaper->aqm){
+        if (m_shaper->macQueue->GetSize () >= m_shaper->macLimit){
+          return;  // resumed by the next transmission of the sender
+        }
+        if (m_shaper->codel.ShouldDrop (now, now - m_queue.front ().second, m_queue.size () == 1)){
+          m_queue.pop_front ();
+          continue;
+        }
+      }
+      double cost = ExchangeAirtime (head->GetSize ());
+      if (m_shaper->limited && !m_shaper->bucket.Take (now, cost)){
+        if (!m_release.IsRunning ()){
+          m_release = Simulator::Schedule (Seconds (m_shaper->bucket.Wait (now, cost)), &ShapedSocket::Release, this);
+        }
+        return;
+      }
+      m_queue.pop_front ();
+      m_inner->Send (head, 0);
+    }
+  }
+
+  virtual int SendTo (Ptr<Packet> p, uint32_t flags, const Address &to) { return m_inner->SendTo (p, flags, to); }
+  virtual SocketErrno GetErrno () const { return m_inner->GetErrno (); }
+  virtual SocketType GetSocketType () const { return m_inner->GetSocketType (); }
+  virtual Ptr<Node> GetNode () const { return m_inner->GetNode (); }
+  virtual int Bind (const Address &address) { return m_inner->Bind (address); }
+  virtual int Bind () { return m_inner->Bind (); }
+  virtual int Bind6 () { return m_inner->Bind6 (); }
+  virtual int Close () { m_release.Cancel (); return m_inner->Close (); }
+  virtual int ShutdownSend () { return m_inner->ShutdownSend (); }
+  virtual int ShutdownRecv () { return m_inner->ShutdownRecv (); }
+  virtual int Listen () { return m_inner->Listen (); }
+  virtual uint32_t GetTxAvailable () const { return m_inner->GetTxAvailable (); }
+  virtual uint32_t GetRxAvailable () const { return m_inner->GetRxAvailable (); }
+  virtual Ptr<Packet> Recv (uint32_t maxSize, uint32_t flags) { return m_inner->Recv (maxSize, flags); }
+  virtual Ptr<Packet> RecvFrom (uint32_t maxSize, uint32_t flags, Address &from) { return m_inner->RecvFrom (maxSize, flags, from); }
+  virtual int GetSockName (Address &address) const { return m_inner->GetSockName (address); }
+  virtual bool SetAllowBroadcast (bool allow) { return m_inner->SetAllowBroadcast (allow); }
+  virtual bool GetAllowBroadcast () const { return m_inner->GetAllowBroadcast (); }
+
+  virtual int Connect (const Address &address){
+    int status = m_inner->Connect (address);
+    if (status == 0){
+      NotifyConnectionSucceeded ();
+    }else {
+      NotifyConnectionFailed ();
+    }
+    return status;
+  }
+
+private:
+  Ptr<Socket> m_inner;
+  ShaperState *m_shaper;
+  std::deque<std::pair<Ptr<Packet>, double> > m_queue;  // packet, enqueue time
+  EventId m_release;
+};
+
+class ShapedUdpSocketFactory : public SocketFactory {
+public:
+  static TypeId GetTypeId (void){
+    static TypeId tid = TypeId ("ns3::ShapedUdpSocketFactory").SetParent<SocketFactory> ();
+    return tid;
+  }
+
+  void SetShaper (ShaperState *shaper) { m_shaper = shaper; }
+
+  virtual Ptr<Socket> CreateSocket (void){
+    Ptr<Socket> inner = GetObject<UdpSocketFactory> ()->CreateSocket ();
+    Ptr<ShapedSocket> socket = CreateObject<ShapedSocket> (inner, m_shaper);
+    m_shaper->socket = PeekPointer (socket);
+    return socket;
+  }
+
+private:
+  ShaperState *m_shaper;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (ShapedUdpSocketFactory);
+
+static void SenseNeighbours (ShaperState *shaper, Time start, Time duration, WifiPhy::State state){
+  if (state == WifiPhy::RX || state == WifiPhy::CCA_BUSY){
+    shaper->busy += duration.GetSeconds ();
+  }
+}
+
+// The MAC took a packet off its queue: let the AQM queue refill it.
+static void ResumeSource (ShaperState *shaper, Ptr<const Packet> packet){
+  if (shaper->socket != NULL){
+    Simulator::ScheduleNow (&ShapedSocket::Release, shaper->socket);
+  }
+}
+
+static void TuneShaper (ShaperState *shaper){
+  double share = TunedShare (shaper->busy / SHAPER_INTERVAL, shaper->gain, 0.02, 1);
+  shaper->bucket.SetRate (Simulator::Now ().GetSeconds (), share);
+  shaper->busy = 0;
+  Simulator::Schedule (Seconds (SHAPER_INTERVAL), &TuneShaper, shaper);
+}
+
+// Send times of the packets in flight of one pair, and the delays of those delivered in the window.
+struct DelayProbe {
+  std::map<uint64_t, double> sent;  // packet uid -> s
+  double sum;
+  uint64_t count;
+  double from, to;
+};
+
+static void ProbeSent (DelayProbe *probe, Ptr<const Packet> packet){
+  probe->sent[packet->GetUid ()] = Simulator::Now ().GetSeconds ();
+}
+
+static void ProbeReceived (DelayProbe *probe, Ptr<const Packet> packet, const Address &from){
+  std::map<uint64_t, double>::iterator it = probe->sent.find (packet->GetUid ());
+  if (it == probe->sent.end ()){
+    return;
+  }
+  double now = Simulator::Now ().GetSeconds ();
+  if (now >= probe->from && now <= probe->to){
+    probe->sum += now - it->second;
+    probe->count++;
+  }
+  probe->sent.erase (it);
+}
+
+// Transmit time of one PHY within the attack window.
+struct AirtimeProbe {
+  double from, to;  // s
+  double tx;        // s
+};
+
+static void MeasureAirtime (AirtimeProbe *probe, Time start, Time duration, WifiPhy::State state){
+  if (state != WifiPhy::TX){
+    return;
+  }
+  double begin = std::max (start.GetSeconds (), probe->from);
+  double end = std::min ((start + duration).GetSeconds (), probe->to);
+  probe->tx += std::max (end - begin, 0.0);
+}
+
+// Building, propagation loss model and node positions of a scenario.
+struct Topology {
+  Ptr<PropagationLossModel> loss;
+  std::vector<Ptr<MobilityModel> > mobility;
+  Ptr<HybridBuildingsPropagationLossModel> building;  // the building model, also when loss is a table
+  BuildingGeometry geometry;
+  std::vector<Position> positions;
+};
+
+static const size_t LOSS_BATCH_NODES = 128;  // layouts from this size on use the batch path
+
+/* Fixed random stream indices. ns-3 otherwise numbers the streams of new
+ * objects from a process-wide counter, so a run would draw different numbers
+ * after the zygote warm-up or an earlier job of the same worker.
+ */
+static const int64_t STREAM_LOSS = 0;        // shadowing of the building model
+static const int64_t STREAM_SHADOWING = 16;  // shadowing added to the batch loss matrix
+static const int64_t STREAM_NODES = 32;      // mobility, wifi, IP stack and traffic, in that order
+
+/* Loss matrix of the building model by rows (cdos-loss-batch.h), plus the
+ * shadowing the model would add: an independent draw per ordered pair with
+ * the model's indoor sigma. Pairs the batch does not cover go to the model.
+ */
+static LossMatrix ComputeLossMatrixBatch (const Topology &topology){
+  LossMatrix loss = LossBatch (topology.geometry, topology.positions).Matrix (DefaultWorkers (), true);
+  DoubleValue sigma;
+  topology.building->GetAttribute ("ShadowSigmaIndoor", sigma);
+  Ptr<NormalRandomVariable> shadowing = CreateObject<NormalRandomVariable> ();
+  shadowing->SetAttribute ("Variance", DoubleValue (sigma.Get () * sigma.Get ()));
+  shadowing->SetStream (STREAM_SHADOWING);
+  for (size_t i = 0; i < loss.size (); ++i){
+    for (size_t j = 0; j < loss.size (); ++j){
+      if (i == j){
+        continue;
+      }
+      if (std::isnan (loss[i][j])){
+        loss[i][j] = -topology.building->CalcRxPower (0, topology.mobility[i], topology.mobility[j]);
+      }else{
+        loss[i][j] += shadowing->GetValue ();
+      }
+    }
+  }
+  return loss;
+}
+
+// Path loss (dB) between all nodes of a topology, from the row to the column node.
+static LossMatrix ComputeLossMatrix (const Topology &topology){
+  size_t n = topology.mobility.size ();
+  if (n >= LOSS_BATCH_NODES && PeekPointer (topology.loss) == PeekPointer (topology.building)){
+    return ComputeLossMatrixBatch (topology);
+  }
+  LossMatrix loss (n, std::vector<double> (n, 0));
+  for (size_t i = 0; i < n; ++i){
+    for (size_t j = 0; j < n; ++j){
+      if (i != j){
+        loss[i][j] = -topology.loss->CalcRxPower (0, topology.mobility[i], topology.mobility[j]);
+      }
+    }
+  }
+  return loss;
+}
+
+static Topology CreateTopology (const ExperimentConfig &config){
+  Topology topology;
+  // The building of the paper unless a floor plan describes the site
+  FloorPlan plan;
+  plan.wallLoss = config.wallLoss;
+  std::string error;
+  if (!config.floorPlan.empty () && !LoadFloorPlan (config.floorPlan, plan, error)){
+    NS_FATAL_ERROR (error);
+  }
+
+  // Place the nodes: the configured layout, the floor plan, else the chain of the paper.
+  // The building of the paper grows by whole rooms to hold a longer chain; any
+  // other node outside the building is an error, as the model has no outdoors.
+  std::vector<Position> layout = ParseLayout (config.layout);
+  for (size_t i = 0; i < config.numofNode; ++i){
+    Position p = {43.5-config.nodeSpacing*i, 0, 1};
+    if (i < layout.size ()){
+      p = layout[i];
+    }else if (i < plan.nodes.size ()){
+      p = plan.nodes[i];
+    }else if (config.floorPlan.empty ()){
+      plan.ExtendTo (p.x);
+    }
+    topology.positions.push_back (p);
+  }
+  for (size_t i = 0; i < topology.positions.size (); ++i){
+    const Position &p = topology.positions[i];
+    if (!plan.Contains (p)){
+      std::ostringstream os;
+      os << "node " << i << " at (" << p.x << ", " << p.y << ", " << p.z << ") is outside the building ["
+         << plan.box[0] << ", " << plan.box[1] << "] x [" << plan.box[2] << ", " << plan.box[3] << "] x ["
+         << plan.box[4] << ", " << plan.box[5] << "]";
+      NS_FATAL_ERROR (os.str ());
+    }
+  }
+
+  // Create a one layer office building with 11 rooms, more for a longer chain.
+  Ptr<Building> building1 = CreateObject<Building> ();
+  building1->SetBoundaries (Box (plan.box[0], plan.box[1], plan.box[2], plan.box[3], plan.box[4], plan.box[5]));
+  building1->SetBuildingType (Building::Office);
+  building1->SetExtWallsType (Building::ConcreteWithWindows);
+  building1->SetNRoomsX(plan.roomsX);
+  building1->SetNRoomsY(plan.roomsY);
+  building1->SetNFloors(plan.floors);
+
+  Ptr<HybridBuildingsPropagationLossModel> propagationLossModel = CreateObject<HybridBuildingsPropagationLossModel> ();
+  propagationLossModel->SetAttribute ("Frequency", DoubleValue (2.4e+09));
+  propagationLossModel->SetAttribute ("InternalWallLoss", DoubleValue (plan.wallLoss));
+  propagationLossModel->AssignStreams (STREAM_LOSS);
+  topology.loss = propagationLossModel;
+  topology.building = propagationLossModel;
+  for (int i = 0; i < 6; ++i){
+    topology.geometry.box[i] = plan.box[i];
+  }
+  topology.geometry.roomsX = plan.roomsX;
+  topology.geometry.roomsY = plan.roomsY;
+  topology.geometry.floors = plan.floors;
+  topology.geometry.wallLoss = plan.wallLoss;
+
+  for (size_t i = 0; i < topology.positions.size (); ++i){
+    const Position &p = topology.positions[i];
+    Ptr<ConstantPositionMobilityModel> pos = CreateObject<ConstantPositionMobilityModel> ();
+    pos->SetPosition (Vector (p.x, p.y, p.z));
+    pos->AggregateObject (CreateObject<MobilityBuildingInfo> ());
+    BuildingsHelper::MakeConsistent (pos);
+    topology.mobility.push_back (pos);
+  }
+  if (config.floorPlan.empty ()){
+    return topology;
+  }
+
+  // Freeze the model losses plus extra walls and measurements into a loss table
+  LossMatrix loss = ComputeLossMatrix (topology);
+  plan.ApplyMeasurements (loss);
+  Ptr<MatrixPropagationLossModel> table = CreateObject<MatrixPropagationLossModel> ();
+  table->SetDefaultLoss (1000);
+  for (size_t i = 0; i < loss.size (); ++i){
+    for (size_t j = 0; j < loss.size (); ++j){
+      if (i == j){
+        continue;
+      }
+      bool measured = plan.measured.count (std::make_pair (i, j)) || plan.measured.count (std::make_pair (j, i));
+      double wall = measured ? 0 : plan.ExtraWallLoss (topology.positions[i], topology.positions[j]);
+      table->SetLoss (topology.mobility[i], topology.mobility[j], loss[i][j] + wall, false);
+    }
+  }
+  topology.loss = table;
+  return topology;
+}
+
+/* Applies the per-node transmit power and carrier-sense threshold. A frame
+ * above the energy detection threshold keeps the medium busy as well, so a
+ * threshold above it raises the energy detection threshold too.
+ */
+static void ConfigurePhy (NetDeviceContainer devices, const ExperimentConfig &config){
+  std::vector<double> power = SplitValues (config.txPower);
+  std::vector<double> threshold = SplitValues (config.ccaThreshold);
+  for (size_t i = 0; i < devices.GetN (); ++i){
+    Ptr<YansWifiPhy> phy = DynamicCast<YansWifiPhy> (DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ());
+    if (i < power.size ()){
+      phy->SetTxPowerStart (power[i]);
+      phy->SetTxPowerEnd (power[i]);
+    }
+    if (i < threshold.size ()){
+      phy->SetCcaMode1Threshold (threshold[i]);
+      phy->SetEdThreshold (std::max (phy->GetEdThreshold (), threshold[i]));
+    }
+  }
+}
+
+/* Applies the per-role EDCA parameters to the best-effort queue of every
+ * sender; the untagged UDP traffic of the scenario is all best effort. The
+ * TXOP limit becomes the MTU of the sender's device (TxopMtu), so that every
+ * channel access carries one IP packet or fragment that fits the limit.
+ */
+static void ConfigureEdca (NodeContainer nodes, const ExperimentConfig &config){
+  for (size_t i = 0; i + 1 < nodes.GetN (); i += 2){
+    EdcaParams p = ParseEdca (config.edca, i, nodes.GetN ());
+    std::ostringstream path;
+    path << "/NodeList/" << nodes.Get (i)->GetId () << "/DeviceList/0/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/BE_EdcaTxopN";
+    Config::MatchContainer edca = Config::LookupMatches (path.str ());
+    for (uint32_t k = 0; k < edca.GetN (); ++k){
+      if (p.aifsn >= 0) edca.Get (k)->SetAttribute ("Aifsn", UintegerValue (p.aifsn));
+      if (p.cwMin >= 0) edca.Get (k)->SetAttribute ("MinCw", UintegerValue (p.cwMin));
+      if (p.cwMax >= 0) edca.Get (k)->SetAttribute ("MaxCw", UintegerValue (p.cwMax));
+    }
+    uint32_t mtu = TxopMtu (p.txopLimit, config.enableCtsRts);
+    Ptr<NetDevice> device = nodes.Get (i)->GetDevice (0);
+    if (mtu > 0 && mtu < device->GetMtu ()){
+      device->SetMtu ((uint16_t)mtu);
+    }
+  }
+}
 
 // start a single experiment 
-void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimulation, double FirstNodeLoad, double RestNodeLoad, uint16_t PktLength){
+ExperimentResult experiment (const ExperimentConfig &config){
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  PerfCounters perf (config.perfCounters);
+  std::vector<double> perfBegin = perf.Read ();
+  if (!config.scheduler.empty ()){
+    ObjectFactory scheduler;
+    scheduler.SetTypeId (config.scheduler);
+    Simulator::SetScheduler (scheduler);
+  }
+  bool enableCtsRts = config.enableCtsRts;
+  uint16_t NumofNode = config.numofNode;
+  uint16_t DurationofSimulation = config.durationofSimulation;
+  double FirstNodeLoad = config.firstNodeLoad;
+  double RestNodeLoad = config.restNodeLoad;
+  uint16_t PktLength = config.pktLength;
+  RngSeedManager::SetSeed (config.seed);
+  RngSeedManager::SetRun (config.run);
+
   // 0. Enable or disable CTS/RTS
   UintegerValue ctsThr = (enableCtsRts ? UintegerValue (100) : UintegerValue (10000000));
   Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", ctsThr);
   Config::SetDefault ("ns3::WifiNetDevice::Mtu", UintegerValue(2296));
+  Config::SetDefault ("ns3::WifiMacQueue::MaxPacketNumber", UintegerValue (config.macQueueSize));
+  Config::SetDefault ("ns3::WifiMacQueue::MaxDelay", TimeValue (Seconds (config.macQueueDelay)));
   /**Static ARP setup**/
   Config::SetDefault ("ns3::ArpCache::DeadTimeout", TimeValue (Seconds (0)));
   Config::SetDefault ("ns3::ArpCache::AliveTimeout", TimeValue (Seconds (120000)));
@@ -66,31 +681,27 @@ void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimul
   nodes.Create (NumofNode);
 
   // 2. Create network topology using  building model
-  // Create a one layer office building with 11 rooms.
-  Ptr<Building> building1 = CreateObject<Building> ();
-  building1->SetBoundaries (Box (0, 44, -3, 3, 0, 3));
-  building1->SetBuildingType (Building::Office);
-  building1->SetExtWallsType (Building::ConcreteWithWindows);
-  building1->SetNRoomsX(11);
-  building1->SetNRoomsY(1);
-  building1->SetNFloors(1);
-
-  // Place the nodes in the building
-  Ptr<HybridBuildingsPropagationLossModel> propagationLossModel = CreateObject<HybridBuildingsPropagationLossModel> ();
-  propagationLossModel->SetAttribute ("Frequency", DoubleValue (2.4e+09));
-  propagationLossModel->SetAttribute ("InternalWallLoss", DoubleValue (12));
+  Topology topology = CreateTopology (config);
+  Ptr<PropagationLossModel> propagationLossModel = topology.loss;
+  int64_t stream = STREAM_NODES;
   for (size_t i = 0; i < NumofNode; ++i){
-    Ptr<ConstantPositionMobilityModel> pos = CreateObject<ConstantPositionMobilityModel> ();
-    nodes.Get (i)->AggregateObject (pos);
-    pos->SetPosition(Vector (43.5-8*i, 0, 1));
-    pos->AggregateObject (CreateObject<MobilityBuildingInfo> ());
-    BuildingsHelper::MakeConsistent (pos);
+    nodes.Get (i)->AggregateObject (topology.mobility[i]);
+    stream += topology.mobility[i]->AssignStreams (stream);
   }
 
-  // 3.Create & setup wifi channel
-  Ptr<YansWifiChannel> wifiChannel = CreateObject <YansWifiChannel> ();
-  wifiChannel->SetPropagationLossModel (propagationLossModel);
-  wifiChannel->SetPropagationDelayModel (CreateObject <ConstantSpeedPropagationDelayModel> ());
+  // 3.Create & setup wifi channel, one per channel index of the pairs (non-overlapping channels)
+  std::vector<double> channelOf = SplitValues (config.channels);
+  std::vector<Ptr<YansWifiChannel> > wifiChannels;
+  size_t pairs = (NumofNode + 1) / 2;
+  for (size_t i = 0; i < pairs; ++i){
+    size_t c = i < channelOf.size () ? (size_t)channelOf[i] : 0;
+    while (wifiChannels.size () <= c){
+      Ptr<YansWifiChannel> wifiChannel = CreateObject <YansWifiChannel> ();
+      wifiChannel->SetPropagationLossModel (propagationLossModel);
+      wifiChannel->SetPropagationDelayModel (CreateObject <ConstantSpeedPropagationDelayModel> ());
+      wifiChannels.push_back (wifiChannel);
+    }
+  }
 
   // 4. Install wireless devices
   /*constant rate wifi manager*/
@@ -99,37 +710,100 @@ void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimul
   wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", 
                                 "DataMode",StringValue ("ErpOfdmRate6Mbps"), 
                                 "ControlMode", StringValue("DsssRate1Mbps"),
-                                "FragmentationThreshold",UintegerValue(2300),
-                                "MaxSlrc", UintegerValue(7));
+                                "FragmentationThreshold",UintegerValue(config.fragThreshold),
+                                "MaxSlrc", UintegerValue(config.maxSlrc));
   YansWifiPhyHelper wifiPhy =  YansWifiPhyHelper::Default ();
-  wifiPhy.SetChannel (wifiChannel);
 	
-  NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
-  wifiMac.SetType ("ns3::AdhocWifiMac"); // use ad-hoc MAC
-  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, nodes);	
+  // Install pair by pair, each on its channel; devices stay in node order
+  NetDeviceContainer devices;
+  for (size_t i = 0; i < pairs; ++i){
+    NodeContainer pair;
+    pair.Add (nodes.Get (2 * i));
+    if (2 * i + 1 < NumofNode){
+      pair.Add (nodes.Get (2 * i + 1));
+    }
+    wifiPhy.SetChannel (wifiChannels[i < channelOf.size () ? (size_t)channelOf[i] : 0]);
+    if (config.qos){
+      QosWifiMacHelper wifiMac = QosWifiMacHelper::Default ();
+      wifiMac.SetType ("ns3::AdhocWifiMac");
+      devices.Add (wifi.Install (wifiPhy, wifiMac, pair));
+    }else {
+      NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
+      wifiMac.SetType ("ns3::AdhocWifiMac"); // use ad-hoc MAC
+      devices.Add (wifi.Install (wifiPhy, wifiMac, pair));
+    }
+  }
+  if (config.qos){
+    ConfigureEdca (nodes, config);
+  }
+  ConfigurePhy (devices, config);
+  stream += wifi.AssignStreams (devices, stream);
 
   // 5. Install IP stack & assign IP addresses
   InternetStackHelper internet;
   internet.Install (nodes);
+  stream += internet.AssignStreams (nodes, stream);
   Ipv4AddressHelper ipv4;
   ipv4.SetBase ("10.0.0.0", "255.0.0.0");
   ipv4.Assign (devices);
 
+  // Airtime shapers and AQM queues between the traffic sources and their sockets
+  bool shaping = config.shaperShare > 0 || config.shaperAuto || config.aqm == "codel";
+  std::vector<ShaperState> shapers (NumofNode / 2);
+  for (size_t i = 0; shaping && i < shapers.size (); ++i){
+    ShaperState &shaper = shapers[i];
+    std::ostringstream path;
+    path << "/NodeList/" << nodes.Get (2 * i)->GetId () << "/DeviceList/0/$ns3::WifiNetDevice/";
+    shaper.limited = config.shaperShare > 0 || config.shaperAuto;
+    shaper.bucket = TokenBucket (config.shaperShare > 0 ? config.shaperShare : config.shaperGain, SHAPER_BURST);
+    shaper.selfTuning = config.shaperAuto;
+    shaper.gain = config.shaperGain;
+    shaper.busy = 0;
+    shaper.aqm = config.aqm == "codel";
+    shaper.codel = CoDel (config.codelTarget, config.codelInterval);
+    shaper.macLimit = config.macQueueSize;
+    shaper.socket = NULL;
+    Ptr<ShapedUdpSocketFactory> factory = CreateObject<ShapedUdpSocketFactory> ();
+    factory->SetShaper (&shaper);
+    nodes.Get (2 * i)->AggregateObject (factory);
+    if (shaper.selfTuning){
+      Config::ConnectWithoutContext (path.str () + "Phy/$ns3::YansWifiPhy/State/State", MakeBoundCallback (&SenseNeighbours, &shaper));
+      Simulator::Schedule (Seconds (SHAPER_INTERVAL), &TuneShaper, &shaper);
+    }
+    if (shaper.aqm){
+      shaper.macQueue = LookupMacQueue (path.str (), config.qos);
+      Config::ConnectWithoutContext (path.str () + "Phy/PhyTxBegin", MakeBoundCallback (&ResumeSource, &shaper));
+    }
+  }
+
   // 6. Install applications: the UDP packets are generated by Poisson traffic
   ApplicationContainer cbrApps;
   uint16_t cbrPort = 12345;
   std::vector<OnOffHelper*> onoffhelpers;
   std::vector<PacketSinkHelper*> sinks;
+  std::vector<Ptr<PacketSink> > sinkApps;
+  std::vector<Ptr<Application> > sourceApps;
+  std::vector<double> offered;
   for (size_t i = 0; i < (NumofNode/2); ++i){
     //set nodes as senders
     std::stringstream ipv4address;
     std::stringstream offtime_first;
     std::stringstream offtime_rest;
     ipv4address << "10.0.0." << (i*2+2);
-    OnOffHelper *onoffhelper = new OnOffHelper("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address (ipv4address.str().c_str()), cbrPort+i));
+    OnOffHelper *onoffhelper = new OnOffHelper(shaping ? "ns3::ShapedUdpSocketFactory" : "ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address (ipv4address.str().c_str()), cbrPort+i));
     onoffhelper->SetAttribute ("PacketSize", UintegerValue (PktLength));
     if ( i == (uint16_t)(NumofNode/2-1) ){
-      if (FirstNodeLoad == 1){
+      if (config.attackPattern == "burst"){
+        // periodic bursts at the PHY rate, the first one at the attack start
+        std::stringstream ontime_burst;
+        ontime_burst << "ns3::ConstantRandomVariable[Constant=" << config.burstDuty * config.burstPeriod << "]";
+        onoffhelper->SetAttribute ("OnTime",  StringValue (ontime_burst.str()));
+        offtime_first << "ns3::ConstantRandomVariable[Constant=" << (1 - config.burstDuty) * config.burstPeriod << "]";
+        onoffhelper->SetAttribute ("OffTime", StringValue (offtime_first.str()));
+        if (config.attackPktLength > 0){
+          onoffhelper->SetAttribute ("PacketSize", UintegerValue (config.attackPktLength));
+        }
+      }else if (FirstNodeLoad == 1){
         onoffhelper->SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
         onoffhelper->SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
       }else if (FirstNodeLoad == 0){
@@ -144,8 +818,9 @@ void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimul
         onoffhelper->SetAttribute ("OffTime", StringValue (offtime_first.str()));
       }
       onoffhelper->SetAttribute ("DataRate", StringValue ("6000000bps"));
-      onoffhelper->SetAttribute ("StartTime", TimeValue (Seconds (53)));
-      onoffhelper->SetAttribute ("StopTime", TimeValue (Seconds (153)));
+      onoffhelper->SetAttribute ("StartTime", TimeValue (Seconds (config.attackStart)));
+      onoffhelper->SetAttribute ("StopTime", TimeValue (Seconds (config.attackStop)));
+      offered.push_back ((config.attackPattern == "burst" ? config.burstDuty : FirstNodeLoad) * 6);
     } else {
       std::stringstream ontime_rest;
       double pkt_time_rest = (double)1/6000000 * PktLength*8;
@@ -155,13 +830,21 @@ void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimul
       onoffhelper->SetAttribute ("OffTime", StringValue (offtime_rest.str()));
       onoffhelper->SetAttribute ("DataRate", StringValue ("6000000bps"));
       onoffhelper->SetAttribute ("StartTime", TimeValue (Seconds (3.100+i*0.01)));
+      offered.push_back (RestNodeLoad * 6);
     }
-    cbrApps.Add (onoffhelper->Install (nodes.Get (i*2)));
+    ApplicationContainer sourceApp = onoffhelper->Install (nodes.Get (i*2));
+    cbrApps.Add (sourceApp);
+    sourceApps.push_back (sourceApp.Get (0));
     onoffhelpers.push_back(onoffhelper);
 
     //set nodes as receivers
     PacketSinkHelper *sink = new PacketSinkHelper("ns3::UdpSocketFactory",Address(InetSocketAddress (Ipv4Address::GetAny (), cbrPort+i)));
-    cbrApps.Add (sink->Install (nodes.Get(i*2+1)));
+    ApplicationContainer sinkApp = sink->Install (nodes.Get(i*2+1));
+    cbrApps.Add (sinkApp);
+    sinkApps.push_back (DynamicCast<PacketSink> (sinkApp.Get (0)));
+  }
+  if (!onoffhelpers.empty ()){
+    stream += onoffhelpers[0]->AssignStreams (nodes, stream);
   }
  
   /** \internal
@@ -187,26 +870,2106 @@ void experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimul
   }
 
   // 7. Install AthstatsHelper to record the data.
-  mkdir("CDoS-6Mbps-adhoc-UDP-building",S_IRWXU | S_IRWXG | S_IRWXO);
-  char pathname [50];
-  std::stringstream filename;
-  std::stringstream foldername;
-  sprintf (pathname, "./CDoS-6Mbps-adhoc-UDP-building/u_0=%1.2frho=%.2fT=%d",FirstNodeLoad, RestNodeLoad, PktLength);
-  foldername << pathname;
-  filename << pathname << "/nodes";
-  mkdir(foldername.str().c_str(),S_IRWXU | S_IRWXG | S_IRWXO);
   AthstatsHelper athstats;
-  athstats.EnableAthstats (filename.str().c_str(), devices);
+  if (config.enableAthstats){
+    mkdir("CDoS-6Mbps-adhoc-UDP-building",S_IRWXU | S_IRWXG | S_IRWXO);
+    char pathname [50];
+    std::stringstream filename;
+    std::stringstream foldername;
+    sprintf (pathname, "./CDoS-6Mbps-adhoc-UDP-building/u_0=%1.2frho=%.2fT=%d",FirstNodeLoad, RestNodeLoad, PktLength);
+    foldername << pathname;
+    filename << pathname << "/nodes";
+    mkdir(foldername.str().c_str(),S_IRWXU | S_IRWXG | S_IRWXO);
+    athstats.EnableAthstats (filename.str().c_str(), devices);
+  }
+
+  // Measure the delivered throughput of every pair while the attacker is on
+  double windowEnd = std::min (config.attackStop, (double)DurationofSimulation);
+  std::vector<uint64_t> rxAtStart (sinkApps.size ()), rxAtStop (sinkApps.size ());
+  Simulator::Schedule (Seconds (config.attackStart), &RecordRx, &sinkApps, &rxAtStart);
+  Simulator::Schedule (Seconds (windowEnd), &RecordRx, &sinkApps, &rxAtStop);
+
+  // One-way delay of every pair, matched by packet uid from source to sink
+  std::vector<DelayProbe> delayProbes (config.measureDelay ? sinkApps.size () : 0);
+  for (size_t i = 0; i < delayProbes.size (); ++i){
+    delayProbes[i].sum = 0;
+    delayProbes[i].count = 0;
+    delayProbes[i].from = config.attackStart;
+    delayProbes[i].to = windowEnd;
+    sourceApps[i]->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&ProbeSent, &delayProbes[i]));
+    sinkApps[i]->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&ProbeReceived, &delayProbes[i]));
+  }
+
+  // Packets sent by the applications, the unit of the per-packet counter costs
+  uint64_t packets = 0;
+  for (size_t i = 0; config.perfCounters && i < sourceApps.size (); ++i){
+    sourceApps[i]->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&CountSentPacket, &packets));
+  }
+
+  // Airtime the attacker spends transmitting while it is on
+  AirtimeProbe attackAirtime;
+  attackAirtime.from = config.attackStart;
+  attackAirtime.to = windowEnd;
+  attackAirtime.tx = 0;
+  std::ostringstream attackerPath;
+  attackerPath << "/NodeList/" << nodes.Get (NumofNode - 2)->GetId () << "/DeviceList/0/$ns3::WifiNetDevice/Phy/$ns3::YansWifiPhy/State/State";
+  Config::ConnectWithoutContext (attackerPath.str (), MakeBoundCallback (&MeasureAirtime, &attackAirtime));
+
+  // Count the frames handled by the PHYs, the dominant share of the simulator work,
+  // and enforce the watchdog limits
+  RunMonitor monitor;
+  monitor.phyEvents = 0;
+  monitor.begin = begin;
+  monitor.config = &config;
+  monitor.truncated = "none";
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin", MakeBoundCallback (&CountPhyEvent, &monitor));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxBegin", MakeBoundCallback (&CountPhyEvent, &monitor));
+  if (config.maxWallTime > 0 || config.maxEvents > 0 || config.maxRssMb > 0){
+    Simulator::Schedule (MilliSeconds (100), &WatchdogTick, &monitor);
+  }
+
+  // Ordered MAC/PHY events of every node for the determinism checks
+  EventTrace eventTrace;
+  std::vector<EventTap> taps (config.traceEvents || !config.eventLog.empty () ? NumofNode * EVENT_KINDS : 0);
+  if (!config.eventLog.empty () && !eventTrace.Open (config.eventLog)){
+    std::cerr << "cannot write the event log " << config.eventLog << std::endl;
+  }
+  for (size_t k = 0; k < taps.size (); ++k){
+    uint32_t node = (uint32_t)(k / EVENT_KINDS);
+    taps[k].trace = &eventTrace;
+    taps[k].node = node;
+    taps[k].kind = (uint32_t)(k % EVENT_KINDS);
+    const char *sources[EVENT_KINDS] = {"Phy/PhyTxBegin", "Phy/PhyRxBegin", "Phy/PhyRxEnd", "Phy/PhyRxDrop",
+                                        "Mac/MacTx", "Mac/MacRx", "Mac/MacTxDrop", "RemoteStationManager/MacTxDataFailed"};
+    std::ostringstream path;
+    path << "/NodeList/" << nodes.Get (node)->GetId () << "/DeviceList/0/$ns3::WifiNetDevice/" << sources[taps[k].kind];
+    if (taps[k].kind == EVENT_MAC_TX_FAILED){
+      Config::ConnectWithoutContext (path.str (), MakeBoundCallback (&TapFailure, &taps[k]));
+    }else{
+      Config::ConnectWithoutContext (path.str (), MakeBoundCallback (&TapPacket, &taps[k]));
+    }
+  }
+
+  // Failed data transmissions of every sender, and the idle-sense controllers
+  std::vector<SenderState> senders (NumofNode / 2);
+  std::vector<IdleSense> controllers;
+  IdleSenseOptions idleSense;
+  idleSense.target = config.idleTarget;
+  controllers.reserve (senders.size ());
+  for (size_t i = 0; i < senders.size (); ++i){
+    SenderState &sender = senders[i];
+    Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (2 * i));
+    std::ostringstream path;
+    path << "/NodeList/" << nodes.Get (2 * i)->GetId () << "/DeviceList/0/$ns3::WifiNetDevice/";
+    sender.attempts = 0;
+    sender.failures = 0;
+    sender.controller = NULL;
+    Config::ConnectWithoutContext (path.str () + "Phy/PhyTxBegin", MakeBoundCallback (&CountAttempt, &sender));
+    Config::ConnectWithoutContext (path.str () + "RemoteStationManager/MacTxDataFailed", MakeBoundCallback (&CountFailure, &sender));
+    if (config.cwControl != "idle-sense"){
+      continue;
+    }
+    Config::MatchContainer dcf = Config::LookupMatches (path.str () + "Mac/$ns3::RegularWifiMac/" + (config.qos ? "BE_EdcaTxopN" : "DcaTxop"));
+    UintegerValue cwMin;
+    dcf.Get (0)->GetAttribute ("MinCw", cwMin);
+    controllers.push_back (IdleSense (idleSense, cwMin.Get ()));
+    sender.controller = &controllers.back ();
+    sender.dcf = dcf.Get (0);
+    sender.slot = device->GetMac ()->GetSlot ().GetSeconds ();
+    sender.difs = device->GetMac ()->GetSifs ().GetSeconds () + 2 * sender.slot;
+    Config::ConnectWithoutContext (path.str () + "Phy/$ns3::YansWifiPhy/State/State", MakeBoundCallback (&ObservePhyState, &sender));
+  }
+
+  // Cascade-onset detectors at the senders, from the time the traffic has settled
+  std::vector<DetectorState> detectors (config.detect ? NumofNode / 2 : 0);
+  DetectorOptions detectorOptions;
+  detectorOptions.window = config.detectorWindow;
+  detectorOptions.drift = config.detectorDrift;
+  detectorOptions.threshold = config.detectorThreshold;
+  for (size_t i = 0; i < detectors.size (); ++i){
+    DetectorState &state = detectors[i];
+    std::ostringstream path;
+    path << "/NodeList/" << nodes.Get (2 * i)->GetId () << "/DeviceList/0/$ns3::WifiNetDevice/";
+    state.detector = CascadeDetector (detectorOptions);
+    state.queue = LookupMacQueue (path.str (), config.qos);
+    state.window = config.detectorWindow;
+    state.prePeak = 0;
+    Config::ConnectWithoutContext (path.str () + "Phy/PhyTxBegin", MakeBoundCallback (&DetectAttempt, &state));
+    Config::ConnectWithoutContext (path.str () + "RemoteStationManager/MacTxDataFailed", MakeBoundCallback (&DetectFailure, &state));
+    Config::ConnectWithoutContext (path.str () + "Phy/$ns3::YansWifiPhy/State/State", MakeBoundCallback (&DetectBusy, &state));
+    Simulator::Schedule (Seconds (DETECTOR_START), &DetectWindow, &state);
+    Simulator::Schedule (Seconds (config.attackStart), &DetectAttackStart, &state);
+  }
+
+  // Live progress reports, only scheduled when a socket is configured
+  ProgressState progress;
+  if (!config.progressSocket.empty ()){
+    std::ostringstream label;
+    label << "u_0=" << FirstNodeLoad << ",rho=" << RestNodeLoad << ",T=" << PktLength << ",run=" << config.run;
+    progress.publisher.Open (config.progressSocket);
+    progress.label = label.str ();
+    progress.interval = config.progressInterval;
+    progress.duration = DurationofSimulation;
+    progress.sinks = &sinkApps;
+    progress.phyEvents = &monitor.phyEvents;
+    progress.lastRx.assign (sinkApps.size (), 0);
+    progress.lastEvents = 0;
+    progress.lastSim = 0;
+    progress.lastWall = std::chrono::steady_clock::now ();
+    Simulator::Schedule (Seconds (config.progressInterval), &ReportProgress, &progress);
+  }
 
   // 8. Run simulation
   Simulator::Stop (Seconds (DurationofSimulation));
+  std::vector<double> perfRunStart = perf.Read ();
   Simulator::Run ();
+  std::vector<double> perfRunEnd = perf.Read ();
+
+  ExperimentResult result;
+  result.config = config;
+  result.offered = offered;
+  result.truncated = monitor.truncated;
+  result.simulatedTime = Simulator::Now ().GetSeconds ();
+  if (!config.progressSocket.empty ()){
+    std::ostringstream line;
+    line << "worker=" << getpid () << " run=" << progress.label << " t=" << result.simulatedTime << " done=1 truncated=" << result.truncated;
+    progress.publisher.Publish (line.str ());
+  }
+  if (result.IsTruncated () && result.simulatedTime < windowEnd){
+    // a stopped run is measured over the part of the attack window it reached
+    windowEnd = result.simulatedTime;
+    RecordRx (&sinkApps, &rxAtStop);
+  }
+  for (size_t i = 0; i < sinkApps.size (); ++i){
+    double window = windowEnd - config.attackStart;
+    result.throughput.push_back (window > 0 ? (rxAtStop[i] - rxAtStart[i]) * 8 / window / 1e6 : 0);
+  }
+  result.phyEvents = monitor.phyEvents;
+  if (!taps.empty ()){
+    result.eventHash = eventTrace.GetHash ();
+    result.events = eventTrace.GetCount ();
+  }
+  result.attackAirtime = windowEnd > config.attackStart ? attackAirtime.tx / (windowEnd - config.attackStart) : 0;
+  for (size_t i = 0; i < delayProbes.size (); ++i){
+    result.delay.push_back (delayProbes[i].count ? delayProbes[i].sum / delayProbes[i].count : 0);
+  }
+  for (size_t i = 0; i < detectors.size (); ++i){
+    result.alarm.push_back (detectors[i].detector.GetAlarmTime ());
+    result.detectorPeak.push_back (detectors[i].detector.GetPeak ());
+    result.detectorPrePeak.push_back (detectors[i].prePeak);
+  }
+  for (size_t i = 0; i < senders.size (); ++i){
+    result.txFailure.push_back (senders[i].attempts ? (double)senders[i].failures / senders[i].attempts : 0);
+    if (senders[i].controller != NULL){
+      result.contentionWindow.push_back (senders[i].controller->GetCw ());
+    }
+  }
 
   // 9. Cleanup
   Simulator::Destroy ();
+  result.wallTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ();
+  if (config.perfCounters){
+    result.perfSetup = PerfDelta (perfBegin, perfRunStart);
+    result.perfRun = PerfDelta (perfRunStart, perfRunEnd);
+    result.perfTeardown = PerfDelta (perfRunEnd, perf.Read ());
+    result.packets = packets;
+  }
+  return result;
 }
 
-int main (int argc, char **argv){
+ExperimentResult experiment (bool enableCtsRts, uint16_t NumofNode, uint16_t DurationofSimulation, double FirstNodeLoad, double RestNodeLoad, uint16_t PktLength){
+  ExperimentConfig config;
+  config.enableCtsRts = enableCtsRts;
+  config.numofNode = NumofNode;
+  config.durationofSimulation = DurationofSimulation;
+  config.firstNodeLoad = FirstNodeLoad;
+  config.restNodeLoad = RestNodeLoad;
+  config.pktLength = PktLength;
+  return experiment (config);
+}
+
+/* Sweep modes
+ *
+ * Every mode is selected with --mode=<name> and parses its own options on top
+ * of the common ones below. Runs are executed in forked workers (cdos-sweep.h)
+ * and every finished run is appended to the result store results.csv.
+ */
+
+// Options shared by all sweep modes.
+struct SweepOptions {
+  std::string mode;
+  unsigned workers;
+  double tolerance;       // victim throughput shortfall that counts as a cascade
+  std::string store;      // result store, relative to the output folder
+  std::string schedule;   // job order on the worker pool: lpt or fifo
+  bool zygote;            // fork the runs from a warmed-up zygote process
+  bool ring;              // return the results through shared-memory rings
+  unsigned ringBatch;     // results per append to the store in ring mode
+  ExperimentConfig base;  // scenario for the parameters a mode does not sweep
+
+  SweepOptions ()
+    : mode ("paper"), workers (DefaultWorkers ()), tolerance (0.1), store ("results.csv"), schedule ("lpt"),
+      zygote (false), ring (false), ringBatch (64) {}
+};
+
+static const char *MODES = "paper | phase-map | multi-fidelity | surrogate | sobol | queue-submit | queue-worker | dashboard | topology | fragmentation | txop | cw-control | power-tuning | channels | shaper | mac-queue | detector | attack-search | deployment | loss-batch | zygote-bench | perf | determinism";
+
+static void AddSweepArgs (CommandLine &cmd, SweepOptions &opt){
+  cmd.AddValue ("mode", MODES, opt.mode);
+  cmd.AddValue ("workers", "Number of parallel simulation processes", opt.workers);
+  cmd.AddValue ("tolerance", "Victim throughput shortfall counted as a cascade", opt.tolerance);
+  cmd.AddValue ("store", "Result store file in the output folder", opt.store);
+  cmd.AddValue ("schedule", "Job order on the workers: lpt (longest predicted first) or fifo", opt.schedule);
+  cmd.AddValue ("zygote", "Fork the runs from a zygote that did a warm-up run", opt.zygote);
+  cmd.AddValue ("ring", "Collect the results through shared-memory rings and store them in batches, without athstats", opt.ring);
+  cmd.AddValue ("ringBatch", "Results per append to the store in ring mode", opt.ringBatch);
+  cmd.AddValue ("rts", "Enable RTS/CTS", opt.base.enableCtsRts);
+  cmd.AddValue ("nodes", "Number of nodes", opt.base.numofNode);
+  cmd.AddValue ("duration", "Simulated time (s)", opt.base.durationofSimulation);
+  cmd.AddValue ("firstNodeLoad", "Load of the attacking sender", opt.base.firstNodeLoad);
+  cmd.AddValue ("restNodeLoad", "Load of the other senders", opt.base.restNodeLoad);
+  cmd.AddValue ("pktLength", "UDP payload (bytes)", opt.base.pktLength);
+  cmd.AddValue ("attackStart", "Time the attacker turns on (s)", opt.base.attackStart);
+  cmd.AddValue ("attackStop", "Time the attacker turns off (s)", opt.base.attackStop);
+  cmd.AddValue ("wallLoss", "Internal wall loss (dB)", opt.base.wallLoss);
+  cmd.AddValue ("spacing", "Distance between neighbouring nodes (m)", opt.base.nodeSpacing);
+  cmd.AddValue ("maxSlrc", "Long retry limit", opt.base.maxSlrc);
+  cmd.AddValue ("fragThreshold", "MAC fragmentation threshold (bytes, even, at least 256)", opt.base.fragThreshold);
+  cmd.AddValue ("qos", "Use the QoS MAC with EDCA", opt.base.qos);
+  cmd.AddValue ("cwControl", "Contention-window control of the senders: dcf or idle-sense", opt.base.cwControl);
+  cmd.AddValue ("idleTarget", "Idle-sense target of idle slots per transmission", opt.base.idleTarget);
+  cmd.AddValue ("edca", "EDCA per sender role: role:aifsn:cwMin:cwMax:txopUs;... (role attacker, facing, rest or all)", opt.base.edca);
+  cmd.AddValue ("layout", "Node positions x:y:z;x:y:z;... (default: the chain of the paper)", opt.base.layout);
+  cmd.AddValue ("floorPlan", "Floor-plan file with walls, node positions and measured losses", opt.base.floorPlan);
+  cmd.AddValue ("nodeTxPower", "Transmit power per node p0;p1;... (dBm)", opt.base.txPower);
+  cmd.AddValue ("nodeCcaThreshold", "Carrier-sense threshold per node t0;t1;... (dBm)", opt.base.ccaThreshold);
+  cmd.AddValue ("channels", "Channel index per pair c0;c1;... (default: all on channel 0)", opt.base.channels);
+  cmd.AddValue ("shaperShare", "Airtime share of every sender's token-bucket shaper, 0 for none", opt.base.shaperShare);
+  cmd.AddValue ("shaperAuto", "Self-tune the shaper share from the sensed neighbour activity", opt.base.shaperAuto);
+  cmd.AddValue ("shaperGain", "Self-tuned share: gain times the airtime not sensed busy", opt.base.shaperGain);
+  cmd.AddValue ("macQueueSize", "Packets the MAC queue of every device holds", opt.base.macQueueSize);
+  cmd.AddValue ("macQueueDelay", "Lifetime of a packet in the MAC queue (s)", opt.base.macQueueDelay);
+  cmd.AddValue ("aqm", "Queue management above the MAC queue: none or codel", opt.base.aqm);
+  cmd.AddValue ("codelTarget", "CoDel target sojourn time (s)", opt.base.codelTarget);
+  cmd.AddValue ("codelInterval", "CoDel interval (s)", opt.base.codelInterval);
+  cmd.AddValue ("measureDelay", "Record the mean one-way delay of every pair", opt.base.measureDelay);
+  cmd.AddValue ("attackPattern", "Attacker traffic: poisson (firstNodeLoad) or burst", opt.base.attackPattern);
+  cmd.AddValue ("burstPeriod", "Time between the starts of two attacker bursts (s)", opt.base.burstPeriod);
+  cmd.AddValue ("burstDuty", "Share of the burst period the attacker sends at 6 Mbps", opt.base.burstDuty);
+  cmd.AddValue ("attackPktLength", "Packet length of the attacker's bursts (bytes), 0 for pktLength", opt.base.attackPktLength);
+  cmd.AddValue ("detect", "Run the cascade-onset detector at every sender", opt.base.detect);
+  cmd.AddValue ("detectorWindow", "Detector observation window (s)", opt.base.detectorWindow);
+  cmd.AddValue ("detectorDrift", "Detector CUSUM allowance (standard deviations)", opt.base.detectorDrift);
+  cmd.AddValue ("detectorThreshold", "Detector CUSUM alarm level", opt.base.detectorThreshold);
+  cmd.AddValue ("seed", "RNG seed", opt.base.seed);
+  cmd.AddValue ("athstats", "Write athstats traces for every run", opt.base.enableAthstats);
+  cmd.AddValue ("progress", "Unix socket receiving live progress lines", opt.base.progressSocket);
+  cmd.AddValue ("progressInterval", "Simulated seconds between progress lines", opt.base.progressInterval);
+  cmd.AddValue ("maxWallTime", "Watchdog: wall-clock seconds per run, 0 for no limit", opt.base.maxWallTime);
+  cmd.AddValue ("maxEvents", "Watchdog: PHY events per run, 0 for no limit", opt.base.maxEvents);
+  cmd.AddValue ("maxRssMb", "Watchdog: peak resident memory per run (MB), 0 for no limit", opt.base.maxRssMb);
+  cmd.AddValue ("perfCounters", "Store hardware counters of the setup, run and teardown of every run", opt.base.perfCounters);
+  cmd.AddValue ("scheduler", "ns-3 event scheduler, e.g. ns3::HeapScheduler (default ns3::MapScheduler)", opt.base.scheduler);
+  cmd.AddValue ("traceEvents", "Store the hash of the ordered MAC/PHY events of every run", opt.base.traceEvents);
+}
+
+static std::string GetMode (int argc, char **argv){
+  for (int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    if (arg.compare (0, 7, "--mode=") == 0){
+      return arg.substr (7);
+    }
+  }
+  return "paper";
+}
+
+/* One short run in the zygote, so that its children start with the ns-3
+ * symbols bound, the types of the scenario set up and the code paged in.
+ * Nothing of it is kept; experiment() assigns fixed random streams, so the
+ * runs forked afterwards draw the same numbers as in a fresh process.
+ */
+static void WarmUp (ExperimentConfig config){
+  config.durationofSimulation = 1;
+  config.attackStart = 0.5;
+  config.attackStop = 1;
+  config.enableAthstats = false;
+  config.progressSocket = "";
+  config.eventLog = "";
+  config.maxWallTime = 0;
+  config.maxEvents = 0;
+  config.maxRssMb = 0;
+  experiment (config);
+}
+
+/* Runs the configurations on the worker pool and records them in the store.
+ * Job costs are predicted from the wall times already in the store; with the
+ * lpt schedule the most expensive jobs are dispatched first. With --ring the
+ * results come back through shared-memory rings and reach the store in
+ * batches while the sweep runs.
+ */
+static std::vector<ExperimentResult> RunBatch (const SweepOptions &opt, const std::vector<ExperimentConfig> &configs){
+  CostModel costModel;
+  costModel.Fit (LoadResults (OutputPath (opt.store)));
+  std::vector<double> cost;
+  std::vector<size_t> fifo;
+  for (size_t i = 0; i < configs.size (); ++i){
+    cost.push_back (costModel.Predict (configs[i]));
+    fifo.push_back (i);
+  }
+  std::vector<size_t> order = opt.schedule == "lpt" ? LptOrder (cost) : fifo;
+
+  bool ring = opt.ring;
+  for (size_t i = 0; i < configs.size (); ++i){
+    ring = ring && configs[i].numofNode / 2 <= RING_PAIRS;
+  }
+  if (opt.ring && !ring){
+    std::cerr << "batch: more than " << RING_PAIRS << " pairs do not fit a ring record, using the pipes" << std::endl;
+  }
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  std::vector<ExperimentResult> results;
+  if (ring){
+    RingSummary summary;
+    results = RunRing (configs, opt.workers, [&configs] (size_t i){
+      // the rings carry the results, so the runs write no athstats files either
+      ExperimentConfig config = configs[i];
+      config.enableAthstats = false;
+      return experiment (config);
+    }, order, [&opt] (const std::vector<ExperimentResult> &batch){
+      AppendResults (OutputPath (opt.store), batch);
+    }, std::max (opt.ringBatch, 1u), opt.tolerance, summary);
+    std::cout << "ring: " << summary.runs << " runs, " << summary.failed << " failed, " << summary.truncated
+              << " stopped early, " << summary.cascades
+              << " cascades; victim throughput " << summary.victim.mean << " +- " << std::sqrt (summary.victim.Variance ())
+              << " of offered, total " << summary.total.mean << " Mbps, " << summary.wallTime.mean
+              << " s per run; stored in " << summary.batches << " batches" << std::endl;
+  }else{
+    SweepJob job = [&configs] (size_t i){
+      return FormatResult (experiment (configs[i]));
+    };
+    std::vector<std::string> lines = opt.zygote && !configs.empty ()
+      ? RunZygote (configs.size (), opt.workers, job, [&configs] (){ WarmUp (configs[0]); }, order)
+      : RunForked (configs.size (), opt.workers, job, order);
+    for (size_t i = 0; i < lines.size (); ++i){
+      ExperimentResult r;
+      if (!ParseResult (ResultHeader (), lines[i], r)){
+        r = ExperimentResult ();
+        r.config = configs[i];
+      }
+      results.push_back (r);
+    }
+    AppendResults (OutputPath (opt.store), results);
+  }
+  double makespan = std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ();
+  if (costModel.IsFitted () && configs.size () > 1){
+    std::cout << "batch: " << configs.size () << " runs (" << opt.schedule << "), predicted makespan "
+              << ListMakespan (cost, order, opt.workers) << " s (fifo " << ListMakespan (cost, fifo, opt.workers)
+              << " s), actual " << makespan << " s; cost model from " << costModel.GetSamples () << " runs" << std::endl;
+  }
+  for (size_t i = 0; i < results.size (); ++i){
+    const ExperimentResult &r = results[i];
+    if (r.throughput.empty ()){
+      std::cerr << "run " << i << " (rho=" << configs[i].restNodeLoad << " T=" << configs[i].pktLength << ") failed" << std::endl;
+    }else if (r.IsTruncated ()){
+      std::cerr << "run " << i << " (rho=" << configs[i].restNodeLoad << " T=" << configs[i].pktLength << ") stopped by the "
+                << r.truncated << " limit at " << r.simulatedTime << " s" << std::endl;
+    }
+  }
+  return results;
+}
+
+// Uniform (RestNodeLoad, PktLength) grid of the plain sweeps.
+struct GridOptions {
+  double rhoMin, rhoMax, rhoStep;
+  double pktMin, pktMax, pktStep;
+
+  GridOptions () : rhoMin (0.02), rhoMax (0.30), rhoStep (0.02), pktMin (200), pktMax (1500), pktStep (100) {}
+};
+
+static void AddGridArgs (CommandLine &cmd, GridOptions &grid){
+  cmd.AddValue ("rhoMin", "Lowest RestNodeLoad", grid.rhoMin);
+  cmd.AddValue ("rhoMax", "Highest RestNodeLoad", grid.rhoMax);
+  cmd.AddValue ("rhoStep", "RestNodeLoad step", grid.rhoStep);
+  cmd.AddValue ("pktMin", "Shortest PktLength", grid.pktMin);
+  cmd.AddValue ("pktMax", "Longest PktLength", grid.pktMax);
+  cmd.AddValue ("pktStep", "PktLength step", grid.pktStep);
+}
+
+static std::vector<ExperimentConfig> GridConfigs (const ExperimentConfig &base, const GridOptions &grid){
+  std::vector<ExperimentConfig> configs;
+  std::vector<double> rhos = Range (grid.rhoMin, grid.rhoMax, grid.rhoStep);
+  std::vector<double> pkts = Range (grid.pktMin, grid.pktMax, grid.pktStep);
+  for (size_t i = 0; i < rhos.size (); ++i){
+    for (size_t j = 0; j < pkts.size (); ++j){
+      ExperimentConfig c = base;
+      c.restNodeLoad = rhos[i];
+      c.pktLength = (uint16_t)pkts[j];
+      configs.push_back (c);
+    }
+  }
+  return configs;
+}
+
+// Quadtree refinement of the cascade boundary over (RestNodeLoad, PktLength).
+static int PhaseMapMain (int argc, char **argv){
+  SweepOptions opt;
+  PhaseMapOptions pm;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("rhoMin", "Lowest RestNodeLoad", pm.rhoMin);
+  cmd.AddValue ("rhoMax", "Highest RestNodeLoad", pm.rhoMax);
+  cmd.AddValue ("pktMin", "Shortest PktLength", pm.pktMin);
+  cmd.AddValue ("pktMax", "Longest PktLength", pm.pktMax);
+  cmd.AddValue ("coarseRho", "Cells of the initial grid along RestNodeLoad", pm.coarseRho);
+  cmd.AddValue ("coarsePkt", "Cells of the initial grid along PktLength", pm.coarsePkt);
+  cmd.AddValue ("minRhoStep", "Resolution floor along RestNodeLoad", pm.minRhoStep);
+  cmd.AddValue ("minPktStep", "Resolution floor along PktLength", pm.minPktStep);
+  cmd.AddValue ("maxGradient", "Victim throughput change that forces a split", pm.maxGradient);
+  cmd.AddValue ("retries", "Reruns of a point whose run failed or was stopped", pm.retries);
+  cmd.Parse (argc, argv);
+  pm.level = 1 - opt.tolerance;
+
+  PhaseMap map (pm, [&opt] (const std::vector<PhasePoint> &points, unsigned attempt){
+    std::vector<ExperimentConfig> configs;
+    for (size_t i = 0; i < points.size (); ++i){
+      ExperimentConfig c = opt.base;
+      c.restNodeLoad = points[i].first;
+      c.pktLength = points[i].second;
+      // a rerun draws a fresh RNG run, so it does not replay the same failure
+      c.run = opt.base.run + attempt;
+      configs.push_back (c);
+    }
+    std::vector<ExperimentResult> results = RunBatch (opt, configs);
+    std::vector<PhaseSample> samples;
+    for (size_t i = 0; i < results.size (); ++i){
+      PhaseSample s = {points[i].first, points[i].second, HasVerdict (results[i]), IsCascade (results[i], opt.tolerance),
+                       NormalizedThroughput (results[i], 0)};
+      samples.push_back (s);
+    }
+    std::cout << "phase-map: evaluated " << points.size () << " points" << (attempt ? " again" : "") << std::endl;
+    return samples;
+  });
+  unsigned levels = map.Refine ();
+
+  std::ofstream samples (OutputPath ("phase-map-samples.csv").c_str ());
+  samples << "rho,T,cascade,victim\n";
+  std::vector<PhaseSample> all = map.GetSamples ();
+  for (size_t i = 0; i < all.size (); ++i){
+    // -1: no verdict
+    samples << all[i].rho << "," << all[i].pktLength << "," << (all[i].known ? (int)all[i].cascade : -1) << "," << all[i].victim << "\n";
+  }
+  std::ofstream boundary (OutputPath ("phase-map-boundary.csv").c_str ());
+  boundary << "polyline,index,rho,T\n";
+  std::vector<Polyline> lines = map.GetBoundary ();
+  for (size_t l = 0; l < lines.size (); ++l){
+    for (size_t k = 0; k < lines[l].size (); ++k){
+      boundary << l << "," << k << "," << lines[l][k].first << "," << lines[l][k].second << "\n";
+    }
+  }
+  std::cout << "phase-map: " << map.GetRuns () << " runs in " << levels << " levels ("
+            << map.GetUniformRuns () << " for a uniform grid at the same resolution), "
+            << lines.size () << " boundary polylines, " << map.GetUnknown () << " points without a verdict" << std::endl;
+  return 0;
+}
+
+// Short screening runs for the whole grid, full runs only where the verdict is unclear.
+static int MultiFidelityMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  FidelityOptions fo;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("screenStart", "Attacker start of a screening run (s)", fo.screenStart);
+  cmd.AddValue ("screenWindow", "Attack window of a screening run (s)", fo.screenWindow);
+  cmd.AddValue ("margin", "Distance to the verdict threshold that is always promoted", fo.margin);
+  cmd.AddValue ("z", "Width of the counting-noise band in standard errors", fo.z);
+  cmd.AddValue ("replications", "Full-length runs per promoted point", fo.replications);
+  cmd.AddValue ("screenStore", "Result store of the screening runs in the output folder", fo.store);
+  cmd.Parse (argc, argv);
+
+  // 1. Screen every point, into the screening store
+  std::vector<ExperimentConfig> full = GridConfigs (opt.base, grid);
+  std::vector<ExperimentConfig> screening;
+  double cost = 0;
+  for (size_t i = 0; i < full.size (); ++i){
+    screening.push_back (ScreeningConfig (full[i], fo));
+    cost += SimulatedCost (screening.back ());
+  }
+  SweepOptions screenOpt = opt;
+  screenOpt.store = fo.store;
+  std::vector<ExperimentResult> screened = RunBatch (screenOpt, screening);
+
+  // 2. Promote the ambiguous points to replicated full-length runs
+  std::vector<ExperimentConfig> promoted;
+  std::vector<size_t> owner;
+  for (size_t i = 0; i < full.size (); ++i){
+    if (!IsAmbiguous (screened[i], opt.tolerance, fo)){
+      continue;
+    }
+    for (unsigned k = 0; k < fo.replications; ++k){
+      ExperimentConfig c = full[i];
+      c.run = full[i].run + k;
+      promoted.push_back (c);
+      owner.push_back (i);
+      cost += SimulatedCost (c);
+    }
+  }
+  std::vector<ExperimentResult> confirmed = RunBatch (opt, promoted);
+
+  // 3. Final verdict: majority of the full runs, else the screening run
+  std::vector<unsigned> runs (full.size (), 0), cascades (full.size (), 0);
+  std::vector<double> victim (full.size (), 0);
+  for (size_t k = 0; k < confirmed.size (); ++k){
+    if (!HasVerdict (confirmed[k])){
+      continue;
+    }
+    runs[owner[k]]++;
+    cascades[owner[k]] += IsCascade (confirmed[k], opt.tolerance);
+    victim[owner[k]] += NormalizedThroughput (confirmed[k], 0);
+  }
+  std::ofstream out (OutputPath ("multi-fidelity.csv").c_str ());
+  out << "rho,T,screenVictim,fullRuns,victim,cascade\n";
+  size_t unknown = 0;
+  for (size_t i = 0; i < full.size (); ++i){
+    // -1: neither a full run nor the screening run has a verdict
+    int cascade = runs[i] ? 2 * cascades[i] > runs[i]
+      : (HasVerdict (screened[i]) && !IsAmbiguous (screened[i], opt.tolerance, fo) ? IsCascade (screened[i], opt.tolerance) : -1);
+    double v = runs[i] ? victim[i] / runs[i] : NormalizedThroughput (screened[i], 0);
+    unknown += cascade < 0;
+    out << full[i].restNodeLoad << "," << full[i].pktLength << "," << NormalizedThroughput (screened[i], 0) << ","
+        << runs[i] << "," << v << "," << cascade << "\n";
+  }
+  if (unknown > 0){
+    std::cerr << "multi-fidelity: " << unknown << " points without a verdict (failed or stopped runs)" << std::endl;
+  }
+
+  // the plain sweep runs every grid point once at full length
+  double plainRuns = (double)full.size ();
+  double plainCost = 0;
+  for (size_t i = 0; i < full.size (); ++i){
+    plainCost += SimulatedCost (full[i]);
+  }
+  std::cout << "multi-fidelity: " << promoted.size () << " full-length runs instead of " << plainRuns
+            << " (" << plainRuns - promoted.size () << " saved), " << cost << " simulated seconds instead of "
+            << plainCost << " (" << std::setprecision (3) << plainCost / cost << "x less)" << std::endl;
+  return 0;
+}
+
+// Surrogate model of the result store: query it and propose the next runs.
+static int SurrogateMain (int argc, char **argv){
+  SweepOptions opt;
+  unsigned propose = 0;
+  unsigned rounds = 1;
+  unsigned candidates = 2000;
+  unsigned maxPoints = 400;
+  std::string acquisition = "boundary";
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("propose", "Runs proposed per active-learning round", propose);
+  cmd.AddValue ("rounds", "Active-learning rounds; proposals are simulated and added to the store", rounds);
+  cmd.AddValue ("candidates", "Random candidates scored per round", candidates);
+  cmd.AddValue ("maxPoints", "Largest training set kept", maxPoints);
+  cmd.AddValue ("acquisition", "uncertainty | boundary", acquisition);
+  cmd.Parse (argc, argv);
+
+  Surrogate model;
+  for (unsigned round = 0; round < rounds; ++round){
+    // 1. Train on the runs of the base scenario stored so far
+    std::vector<ExperimentResult> store = LoadResults (OutputPath (opt.store));
+    if (!model.Train (store, opt.base, opt.tolerance, maxPoints)){
+      std::cerr << "surrogate: fewer than " << Surrogate::MIN_POINTS << " distinct runs of this scenario with a verdict in "
+                << OutputPath (opt.store) << std::endl;
+      return 1;
+    }
+    std::cout << "surrogate: " << store.size () << " runs, " << model.GetPoints () << " training points, length scale "
+              << model.GetLengthScale () << ", noise " << model.GetNoise () << std::endl;
+
+    // 2. Answer the query point given by the scenario options
+    auto begin = std::chrono::steady_clock::now ();
+    SurrogatePrediction p = model.Predict (opt.base);
+    const unsigned repeat = 10000;
+    for (unsigned i = 1; i < repeat; ++i){
+      p = model.Predict (opt.base);
+    }
+    double us = std::chrono::duration<double, std::micro> (std::chrono::steady_clock::now () - begin).count () / repeat;
+    std::cout << "surrogate: rho=" << opt.base.restNodeLoad << " T=" << opt.base.pktLength << " u0=" << opt.base.firstNodeLoad
+              << " victim=" << p.victim << "+-" << p.victimSd << " P(cascade)=" << p.cascadeProbability << " throughput(Mbps)=";
+    for (size_t i = 0; i < p.throughput.size (); ++i){
+      std::cout << (i ? ";" : "") << p.throughput[i] << "+-" << p.throughputSd[i];
+    }
+    std::cout << " (" << us << " us/query)" << std::endl;
+
+    // 3. Propose and simulate the most informative runs
+    if (propose == 0){
+      break;
+    }
+    std::vector<ExperimentConfig> next = model.Propose (opt.base, propose, candidates, acquisition, opt.base.seed + round);
+    std::string proposals = OutputPath ("surrogate-proposals.csv");
+    bool exists = std::ifstream (proposals.c_str ()).peek () != std::ifstream::traits_type::eof ();
+    std::ofstream out (proposals.c_str (), std::ios::app);
+    if (!exists){
+      out << "round,rho,T,u0,rts,victim,victimSd,cascadeProbability\n";
+    }
+    for (size_t i = 0; i < next.size (); ++i){
+      SurrogatePrediction q = model.Predict (next[i]);
+      out << round << "," << next[i].restNodeLoad << "," << next[i].pktLength << "," << next[i].firstNodeLoad << ","
+          << next[i].enableCtsRts << "," << q.victim << "," << q.victimSd << "," << q.cascadeProbability << "\n";
+    }
+    out.close ();
+    if (round + 1 < rounds){
+      RunBatch (opt, next);
+    }
+  }
+  return 0;
+}
+
+// Sobol indices of the scenario parameters for the victim and total throughput.
+static int SobolMain (int argc, char **argv){
+  SweepOptions opt;
+  std::string spec = "rho:0.02:0.30,u0:0.2:1,T:200:1500,wallLoss:6:18,spacing:6:8.5,maxSlrc:4:10";
+  unsigned samples = 64;
+  unsigned bootstrap = 500;
+  double confidence = 0.95;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("params", "Parameters as name:lo:hi,... using the result store column names", spec);
+  cmd.AddValue ("samples", "Base samples N; N (k + 2) runs are simulated", samples);
+  cmd.AddValue ("bootstrap", "Bootstrap resamples for the confidence intervals", bootstrap);
+  cmd.AddValue ("confidence", "Confidence level of the intervals", confidence);
+  cmd.Parse (argc, argv);
+
+  // 1. Saltelli sample matrices, mapped onto scenario configurations
+  std::vector<SobolParameter> params = ParseSobolParameters (spec);
+  std::vector<std::vector<double> > rows = SaltelliSamples (params, samples, opt.base.seed);
+  std::vector<ExperimentConfig> configs;
+  for (size_t r = 0; r < rows.size (); ++r){
+    ExperimentResult e;
+    e.config = opt.base;
+    for (size_t d = 0; d < params.size (); ++d){
+      double v = rows[r][d];
+      // integer parameters are drawn uniformly over [lo, hi]
+      bool integer = params[d].name == "T" || params[d].name == "maxSlrc" || params[d].name == "nodes";
+      if (integer && params[d].hi > params[d].lo){
+        v = std::floor (params[d].lo + (v - params[d].lo) * (params[d].hi - params[d].lo + 1) / (params[d].hi - params[d].lo));
+        v = std::min (v, params[d].hi);
+      }
+      std::ostringstream value;
+      value << std::setprecision (10) << v;
+      SetResultField (e, params[d].name, value.str ());
+    }
+    configs.push_back (e.config);
+  }
+  std::cout << "sobol: " << configs.size () << " runs for " << params.size () << " parameters" << std::endl;
+
+  // 2. Simulate and compute the indices of both outputs
+  std::vector<ExperimentResult> results = RunBatch (opt, configs);
+  std::vector<double> victim, total;
+  for (size_t r = 0; r < results.size (); ++r){
+    bool ok = HasVerdict (results[r]);
+    victim.push_back (ok ? NormalizedThroughput (results[r], 0) : std::numeric_limits<double>::quiet_NaN ());
+    total.push_back (ok ? TotalThroughput (results[r]) : std::numeric_limits<double>::quiet_NaN ());
+  }
+  std::ofstream out (OutputPath ("sobol.csv").c_str ());
+  out << "output,parameter,S1,S1lo,S1hi,ST,STlo,SThi\n";
+  for (int o = 0; o < 2; ++o){
+    std::string name = o ? "total" : "victim";
+    std::vector<SobolIndex> idx = SobolIndices (o ? total : victim, samples, params.size (), bootstrap, confidence, opt.base.seed);
+    for (size_t d = 0; d < params.size (); ++d){
+      out << name << "," << params[d].name << "," << idx[d].first << "," << idx[d].firstLo << "," << idx[d].firstHi << ","
+          << idx[d].total << "," << idx[d].totalLo << "," << idx[d].totalHi << "\n";
+      std::cout << "sobol: " << name << " " << std::setw (8) << params[d].name << " S1=" << idx[d].first << " ["
+                << idx[d].firstLo << "," << idx[d].firstHi << "] ST=" << idx[d].total << " [" << idx[d].totalLo << ","
+                << idx[d].totalHi << "]" << std::endl;
+    }
+  }
+  return 0;
+}
+
+/* Multi-machine sweeps through a job queue in a shared directory. queue-submit
+ * enqueues a grid in LPT order; queue-worker runs --workers claim loops until
+ * the queue is drained and merges the results into <queue>/<store>.
+ */
+static int QueueSubmitMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  std::string dir = OutputPath ("queue");
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("queue", "Shared queue directory", dir);
+  cmd.Parse (argc, argv);
+
+  std::vector<ExperimentConfig> configs = GridConfigs (opt.base, grid);
+  CostModel costModel;
+  costModel.Fit (LoadResults (dir + "/" + opt.store));
+  std::vector<double> cost;
+  for (size_t i = 0; i < configs.size (); ++i){
+    cost.push_back (costModel.Predict (configs[i]));
+  }
+  std::vector<size_t> order = LptOrder (cost);
+  JobQueue queue (dir, 0);
+  std::ostringstream prefix;
+  prefix << time (NULL) << "-" << queue.GetOwner () << "-";
+  for (size_t k = 0; k < order.size (); ++k){
+    std::ostringstream id;
+    id << std::setw (6) << std::setfill ('0') << k;
+    queue.Submit (prefix.str () + id.str (), configs[order[k]]);
+  }
+  std::cout << "queue-submit: " << configs.size () << " jobs added to " << dir << ", " << queue.Pending () << " pending" << std::endl;
+  return 0;
+}
+
+static std::string QueueWorkerLoop (const std::string &dir, double lease, unsigned attempts, const std::string &store){
+  JobQueue queue (dir, lease, attempts);
+  unsigned runs = 0, failed = 0;
+  while (true){
+    queue.RecoverStale ();
+    std::string id;
+    ExperimentConfig config;
+    if (!queue.Claim (id, config)){
+      if (queue.Claimed () == 0){
+        break;
+      }
+      // other workers are still busy; wait in case one of them dies
+      usleep ((useconds_t)(std::min (lease / 4, 5.0) * 1e6));
+      continue;
+    }
+    // a claim lost to a recovery is being run elsewhere: stop this run
+    bool lost = false;
+    std::vector<std::string> lines = RunForked (1, 1, [&config] (size_t){
+      return FormatResult (experiment (config));
+    }, std::vector<size_t> (), [&queue, &id, &lost] (){
+      lost = lost || !queue.Heartbeat (id);
+      return !lost;
+    }, lease / 4);
+    ExperimentResult r;
+    if (lost){
+      std::cerr << "queue-worker: lost the claim of job " << id << ", run stopped" << std::endl;
+    }else if (ParseResult (ResultHeader (), lines[0], r)){
+      runs += queue.Complete (id, r);
+    }else if (queue.Fail (id)){
+      std::cerr << "queue-worker: job " << id << " failed " << attempts << " times, moved to " << dir << "/failed" << std::endl;
+    }else{
+      failed++;
+    }
+    queue.Merge (dir + "/" + store);
+  }
+  for (size_t i = 0; i < queue.GetCorrupt ().size (); ++i){
+    std::cerr << "queue-worker: job file " << queue.GetCorrupt ()[i] << " is unreadable, moved to " << dir << "/failed" << std::endl;
+  }
+  // drain the finished runs; another worker may be holding the merge lock
+  while (queue.Unmerged () > 0){
+    if (queue.Merge (dir + "/" + store) == 0){
+      usleep (100000);
+    }
+  }
+  std::ostringstream os;
+  os << queue.GetOwner () << " ran " << runs << " jobs, " << failed << " runs failed and were requeued";
+  return os.str ();
+}
+
+static int QueueWorkerMain (int argc, char **argv){
+  SweepOptions opt;
+  std::string dir = OutputPath ("queue");
+  double lease = 120;
+  unsigned attempts = 3;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("queue", "Shared queue directory", dir);
+  cmd.AddValue ("lease", "Seconds after which a silent claim is given to another worker", lease);
+  cmd.AddValue ("attempts", "Failed runs after which a job is moved to failed/", attempts);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> summary = RunForked (opt.workers, opt.workers, [&] (size_t){
+    return QueueWorkerLoop (dir, lease, attempts, opt.store);
+  });
+  for (size_t i = 0; i < summary.size (); ++i){
+    std::cout << "queue-worker: " << summary[i] << std::endl;
+  }
+  JobQueue queue (dir, lease);
+  std::cout << "queue-worker: " << queue.Pending () << " pending, " << queue.Claimed () << " claimed, "
+            << queue.Done () << " done, " << queue.Failed () << " failed" << std::endl;
+  return 0;
+}
+
+// Stand-in dashboard: binds the progress socket and shows the latest line of every run.
+static int DashboardMain (int argc, char **argv){
+  SweepOptions opt;
+  opt.base.progressSocket = "/tmp/cdos-progress.sock";
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.Parse (argc, argv);
+
+  ProgressListener listener;
+  if (!listener.Bind (opt.base.progressSocket)){
+    perror (opt.base.progressSocket.c_str ());
+    return 1;
+  }
+  std::cout << "dashboard: listening on " << opt.base.progressSocket << std::endl;
+  struct Entry {
+    std::string line;
+    double seen, gap;  // wall s of the last report and between the last two
+  };
+  std::map<std::string, Entry> latest;
+  size_t finished = 0;
+  std::string line;
+  while (true){
+    double now = MonotonicSeconds ();
+    bool changed = false;
+    if (listener.Wait (1)){
+      if (!listener.Receive (line)){
+        break;
+      }
+      std::string worker = line.substr (0, line.find (' '));
+      if (line.find (" done=1") != std::string::npos){
+        finished += latest.erase (worker);
+      }else{
+        Entry &e = latest[worker];
+        e.gap = e.line.empty () ? opt.base.progressInterval : now - e.seen;
+        e.seen = now;
+        e.line = line;
+      }
+      changed = true;
+    }
+    // a run that died without its final line goes silent: drop it after a few report intervals
+    for (std::map<std::string, Entry>::iterator it = latest.begin (); it != latest.end ();){
+      if (now - it->second.seen > 3 * std::max (it->second.gap, opt.base.progressInterval)){
+        latest.erase (it++);
+        changed = true;
+      }else{
+        ++it;
+      }
+    }
+    if (!changed){
+      continue;
+    }
+    std::cout << "\033[H\033[2J" << latest.size () << " running, " << finished << " finished" << "\n";
+    for (std::map<std::string, Entry>::iterator it = latest.begin (); it != latest.end (); ++it){
+      std::cout << it->second.line << "\n";
+    }
+    std::cout.flush ();
+  }
+  return 0;
+}
+
+/* Runs every variant of a scenario at every load of the grid, writes the
+ * victim and total throughput of each run to a file, and prints for each
+ * variant the highest load before the first cascade and the mean goodput.
+ */
+static std::vector<ExperimentResult> RunVariants (const SweepOptions &opt, const GridOptions &grid,
+                                                  const std::vector<std::string> &names,
+                                                  const std::vector<ExperimentConfig> &variants, const std::string &file){
+  std::vector<double> rhos = Range (grid.rhoMin, grid.rhoMax, grid.rhoStep);
+  std::vector<ExperimentConfig> configs;
+  for (size_t k = 0; k < variants.size (); ++k){
+    for (size_t i = 0; i < rhos.size (); ++i){
+      ExperimentConfig c = variants[k];
+      c.restNodeLoad = rhos[i];
+      configs.push_back (c);
+    }
+  }
+  std::vector<ExperimentResult> results = RunBatch (opt, configs);
+
+  std::ofstream out (OutputPath (file).c_str ());
+  out << "variant,rho,T,victim,total,cascade\n";
+  std::cout << std::setw (16) << "variant" << std::setw (12) << "max rho" << std::setw (16) << "goodput Mbps" << std::endl;
+  for (size_t k = 0; k < variants.size (); ++k){
+    double feasible = 0, goodput = 0;
+    bool cascaded = false;
+    size_t known = 0;
+    for (size_t i = 0; i < rhos.size (); ++i){
+      const ExperimentResult &r = results[k * rhos.size () + i];
+      if (!HasVerdict (r)){
+        // a failed or stopped run says nothing about this load; -1 in the file
+        out << names[k] << "," << rhos[i] << "," << r.config.pktLength << ",,,-1\n";
+        continue;
+      }
+      bool cascade = IsCascade (r, opt.tolerance);
+      cascaded = cascaded || cascade;
+      if (!cascaded){
+        feasible = rhos[i];
+      }
+      goodput += TotalThroughput (r);
+      known++;
+      out << names[k] << "," << rhos[i] << "," << r.config.pktLength << "," << NormalizedThroughput (r, 0) << ","
+          << TotalThroughput (r) << "," << cascade << "\n";
+    }
+    std::cout << std::setw (16) << names[k] << std::setw (12) << feasible << std::setw (16) << (known ? goodput / known : 0);
+    if (known < rhos.size ()){
+      std::cout << "  (" << rhos.size () - known << " loads without a verdict)";
+    }
+    std::cout << std::endl;
+  }
+  return results;
+}
+
+/* Mitigation by MAC fragmentation: 1500 B application packets split into
+ * SIFS-separated fragment bursts, against the unmitigated 1500 B packets and
+ * the application-level 200 B packets of the paper, over a range of loads.
+ */
+static int FragmentationMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  std::string thresholds = "256,400,600,800";
+  uint16_t shortPkt = 200;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("fragThresholds", "Comma-separated fragmentation thresholds to compare (bytes)", thresholds);
+  cmd.AddValue ("shortPkt", "Application packet length of the packet-shortening mitigation (bytes)", shortPkt);
+  cmd.Parse (argc, argv);
+
+  // Variants: name, packet length, fragmentation threshold
+  std::replace (thresholds.begin (), thresholds.end (), ',', ';');
+  std::vector<double> frag = SplitValues (thresholds);
+  std::vector<std::string> names;
+  std::vector<ExperimentConfig> variants;
+  ExperimentConfig v = opt.base;
+  v.fragThreshold = 2300;
+  names.push_back ("none");
+  variants.push_back (v);
+  v.pktLength = shortPkt;
+  names.push_back ("app-" + std::to_string (shortPkt));
+  variants.push_back (v);
+  for (size_t k = 0; k < frag.size (); ++k){
+    v.pktLength = opt.base.pktLength;
+    v.fragThreshold = (uint32_t)frag[k];
+    names.push_back ("frag-" + std::to_string (v.fragThreshold));
+    variants.push_back (v);
+  }
+  RunVariants (opt, grid, names, variants, "fragmentation.csv");
+  return 0;
+}
+
+/* Caps the airtime per channel access of one sender role with the EDCA TXOP
+ * limit, without touching the application packet size, and compares it with
+ * plain DCF. A limit of 0 is EDCA without a limit; limits the longest frame
+ * exchange already fits change nothing.
+ */
+static int TxopMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  std::string limits = "0,544,1088,2176,3264";
+  std::string role = "facing";
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("txopLimits", "Comma-separated TXOP limits to compare (us)", limits);
+  cmd.AddValue ("txopRole", "Sender role whose TXOP is limited: attacker, facing, rest or all", role);
+  cmd.Parse (argc, argv);
+
+  std::replace (limits.begin (), limits.end (), ',', ';');
+  std::vector<double> txop = SplitValues (limits);
+  std::vector<std::string> names;
+  std::vector<ExperimentConfig> variants;
+  ExperimentConfig v = opt.base;
+  v.qos = false;
+  names.push_back ("dcf");
+  variants.push_back (v);
+  for (size_t k = 0; k < txop.size (); ++k){
+    std::ostringstream spec;
+    spec << opt.base.edca << (opt.base.edca.empty () ? "" : ";") << role << "::::" << txop[k];
+    v.qos = true;
+    v.edca = spec.str ();
+    names.push_back ("txop-" + std::to_string ((int)txop[k]));
+    variants.push_back (v);
+  }
+  RunVariants (opt, grid, names, variants, "txop.csv");
+  return 0;
+}
+
+// Idle-sense contention-window control against the binary exponential backoff of DCF.
+static int CwControlMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  std::string targets = "3.91";
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("idleTargets", "Comma-separated idle-sense targets to compare (idle slots per transmission)", targets);
+  cmd.Parse (argc, argv);
+
+  std::replace (targets.begin (), targets.end (), ',', ';');
+  std::vector<double> target = SplitValues (targets);
+  std::vector<std::string> names;
+  std::vector<ExperimentConfig> variants;
+  ExperimentConfig v = opt.base;
+  v.cwControl = "dcf";
+  names.push_back ("dcf");
+  variants.push_back (v);
+  for (size_t k = 0; k < target.size (); ++k){
+    std::ostringstream name;
+    name << "idle-sense-" << target[k];
+    v.cwControl = "idle-sense";
+    v.idleTarget = target[k];
+    names.push_back (name.str ());
+    variants.push_back (v);
+  }
+  std::vector<ExperimentResult> results = RunVariants (opt, grid, names, variants, "cw-control.csv");
+
+  // Mean failure ratio and final window per sender, over the loads of each variant
+  size_t loads = results.size () / variants.size ();
+  for (size_t k = 0; k < variants.size (); ++k){
+    std::vector<double> failure, cw;
+    for (size_t i = 0; i < loads; ++i){
+      const ExperimentResult &r = results[k * loads + i];
+      failure.resize (std::max (failure.size (), r.txFailure.size ()), 0);
+      cw.resize (std::max (cw.size (), r.contentionWindow.size ()), 0);
+      for (size_t p = 0; p < r.txFailure.size (); ++p){
+        failure[p] += r.txFailure[p] / loads;
+      }
+      for (size_t p = 0; p < r.contentionWindow.size (); ++p){
+        cw[p] += r.contentionWindow[p] / loads;
+      }
+    }
+    std::cout << names[k] << ": failure ratio per sender " << JoinValues (failure);
+    if (!cw.empty ()){
+      std::cout << ", window " << JoinValues (cw);
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
+
+/* Searches per-node transmit power and carrier-sense threshold on the static
+ * loss matrix, then simulates the best candidates next to the default.
+ */
+static int PowerTuningMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  PowerTuningOptions po;
+  unsigned candidates = 3;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("candidates", "Screened settings confirmed by simulation", candidates);
+  cmd.AddValue ("restarts", "Random starts of the coordinate descent", po.restarts);
+  cmd.Parse (argc, argv);
+
+  // 1. Screen on the loss matrix
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  LossMatrix loss = ComputeLossMatrix (CreateTopology (opt.base));
+  Simulator::Destroy ();
+  LinkBudget budget;
+  budget.txPower = SplitValues (opt.base.txPower);
+  budget.ccaThreshold = SplitValues (opt.base.ccaThreshold);
+  PowerTuner tuner (loss, budget, po);
+  PowerCandidate current = tuner.Evaluate (budget.txPower, budget.ccaThreshold);
+  std::vector<PowerCandidate> optima = tuner.Search ();
+  double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - begin).count ();
+  std::cout << "power-tuning: " << optima.size () << " local optima in " << ms << " ms; default: " << current.hidden
+            << " hidden, chain " << current.chain << ", reuse " << current.reuse << std::endl;
+
+  // 2. Confirm the admissible ones that beat the default
+  std::vector<std::string> names (1, "default");
+  std::vector<ExperimentConfig> variants (1, opt.base);
+  for (size_t k = 0; k < optima.size () && variants.size () <= candidates; ++k){
+    const PowerCandidate &c = optima[k];
+    if (!c.admissible || c.score <= current.score){
+      continue;
+    }
+    std::ostringstream name;
+    name << "candidate-" << variants.size ();
+    ExperimentConfig v = opt.base;
+    v.txPower = JoinValues (c.txPower);
+    v.ccaThreshold = JoinValues (c.ccaThreshold);
+    std::cout << name.str () << ": " << c.hidden << " hidden, chain " << c.chain << ", reuse " << c.reuse
+              << ", txPower " << v.txPower << ", ccaThreshold " << v.ccaThreshold << std::endl;
+    names.push_back (name.str ());
+    variants.push_back (v);
+  }
+  RunVariants (opt, grid, names, variants, "power-tuning.csv");
+  return 0;
+}
+
+/* Plans the channels of the pairs by colouring the conflict graph of the
+ * static loss matrix and simulates the plans for several channel counts and
+ * chain lengths against a single shared channel.
+ */
+static int ChannelsMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  std::string chains = "6,10,14";
+  std::string counts = "1,3,0";
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("chainNodes", "Comma-separated chain lengths (nodes)", chains);
+  cmd.AddValue ("channelCounts", "Comma-separated numbers of available channels, 0 for one per pair", counts);
+  cmd.Parse (argc, argv);
+
+  std::replace (chains.begin (), chains.end (), ',', ';');
+  std::replace (counts.begin (), counts.end (), ',', ';');
+  std::vector<double> nodes = SplitValues (chains);
+  std::vector<double> available = SplitValues (counts);
+  LinkBudget budget;
+  budget.txPower = SplitValues (opt.base.txPower);
+  budget.ccaThreshold = SplitValues (opt.base.ccaThreshold);
+  for (size_t n = 0; n < nodes.size (); ++n){
+    // 1. Plan every channel count on the loss matrix of this chain
+    ExperimentConfig base = opt.base;
+    base.numofNode = (uint16_t)nodes[n];
+    ChannelPlanner planner (ComputeLossMatrix (CreateTopology (base)), budget);
+    Simulator::Destroy ();
+    std::cout << "channels: " << base.numofNode << " nodes need " << planner.ChannelsNeeded (true)
+              << " channels without hidden-terminal conflicts, " << planner.ChannelsNeeded (false) << " without any conflict" << std::endl;
+    std::vector<std::string> names;
+    std::vector<ExperimentConfig> variants;
+    for (size_t k = 0; k < available.size (); ++k){
+      unsigned count = available[k] > 0 ? (unsigned)available[k] : (unsigned)planner.GetFlows ();
+      std::vector<unsigned> plan = planner.Plan (count);
+      std::vector<double> channel (plan.begin (), plan.end ());
+      std::ostringstream name;
+      name << count << "-channels";
+      ExperimentConfig v = base;
+      v.channels = JoinValues (channel);
+      std::cout << "  " << name.str () << ": plan " << v.channels << ", conflict weight " << planner.Cost (plan)
+                << ", longest cascade chain " << planner.LongestChain (plan) << std::endl;
+      names.push_back (name.str ());
+      variants.push_back (v);
+    }
+
+    // 2. Simulate the plans
+    std::ostringstream file;
+    file << "channels-" << base.numofNode << ".csv";
+    RunVariants (opt, grid, names, variants, file.str ());
+  }
+  return 0;
+}
+
+// Token-bucket airtime shapers at the senders against unlimited senders.
+static int ShaperMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  std::string shares = "0.2,0.35,0.5";
+  std::string gains = "0.5";
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("shares", "Comma-separated fixed airtime shares to compare", shares);
+  cmd.AddValue ("gains", "Comma-separated gains of the self-tuning shaper to compare", gains);
+  cmd.Parse (argc, argv);
+
+  std::replace (shares.begin (), shares.end (), ',', ';');
+  std::replace (gains.begin (), gains.end (), ',', ';');
+  std::vector<double> share = SplitValues (shares);
+  std::vector<double> gain = SplitValues (gains);
+  std::vector<std::string> names (1, "unlimited");
+  std::vector<ExperimentConfig> variants (1, opt.base);
+  variants[0].shaperShare = 0;
+  variants[0].shaperAuto = false;
+  for (size_t k = 0; k < share.size (); ++k){
+    std::ostringstream name;
+    name << "share-" << share[k];
+    ExperimentConfig v = variants[0];
+    v.shaperShare = share[k];
+    names.push_back (name.str ());
+    variants.push_back (v);
+  }
+  for (size_t k = 0; k < gain.size (); ++k){
+    std::ostringstream name;
+    name << "auto-" << gain[k];
+    ExperimentConfig v = variants[0];
+    v.shaperAuto = true;
+    v.shaperGain = gain[k];
+    names.push_back (name.str ());
+    variants.push_back (v);
+  }
+  std::vector<ExperimentResult> results = RunVariants (opt, grid, names, variants, "shaper.csv");
+
+  // Aggregate throughput kept relative to the unlimited senders
+  size_t loads = results.size () / variants.size ();
+  std::vector<double> total (variants.size (), 0);
+  for (size_t k = 0; k < variants.size (); ++k){
+    for (size_t i = 0; i < loads; ++i){
+      total[k] += TotalThroughput (results[k * loads + i]);
+    }
+  }
+  for (size_t k = 1; k < variants.size (); ++k){
+    std::cout << names[k] << ": " << std::setprecision (3) << (total[0] > 0 ? 100 * total[k] / total[0] : 0)
+              << " % of the unlimited aggregate throughput" << std::endl;
+  }
+  return 0;
+}
+
+// MAC queue depth, packet lifetime and CoDel against the default queue.
+static int MacQueueMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  std::string sizes = "10,50";
+  std::string delays = "0.05,0.5";
+  uint32_t codelQueue = 4;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("queueSizes", "Comma-separated MAC queue depths (packets) to compare", sizes);
+  cmd.AddValue ("maxDelays", "Comma-separated MAC queue lifetimes (s) to compare", delays);
+  cmd.AddValue ("codelQueue", "MAC queue depth under CoDel, 0 for no CoDel variant", codelQueue);
+  cmd.Parse (argc, argv);
+
+  std::replace (sizes.begin (), sizes.end (), ',', ';');
+  std::replace (delays.begin (), delays.end (), ',', ';');
+  std::vector<double> size = SplitValues (sizes);
+  std::vector<double> delay = SplitValues (delays);
+  std::vector<std::string> names (1, "default");
+  std::vector<ExperimentConfig> variants (1, opt.base);
+  variants[0].measureDelay = true;
+  variants[0].aqm = "none";
+  for (size_t k = 0; k < size.size (); ++k){
+    std::ostringstream name;
+    name << "size-" << size[k];
+    ExperimentConfig v = variants[0];
+    v.macQueueSize = (uint32_t)size[k];
+    names.push_back (name.str ());
+    variants.push_back (v);
+  }
+  for (size_t k = 0; k < delay.size (); ++k){
+    std::ostringstream name;
+    name << "lifetime-" << delay[k];
+    ExperimentConfig v = variants[0];
+    v.macQueueDelay = delay[k];
+    names.push_back (name.str ());
+    variants.push_back (v);
+  }
+  if (codelQueue > 0){
+    ExperimentConfig v = variants[0];
+    v.macQueueSize = codelQueue;
+    v.aqm = "codel";
+    names.push_back ("codel");
+    variants.push_back (v);
+  }
+  std::vector<ExperimentResult> results = RunVariants (opt, grid, names, variants, "mac-queue.csv");
+
+  // Mean one-way delay over the loads, of the victim and over all pairs
+  size_t loads = results.size () / variants.size ();
+  for (size_t k = 0; k < variants.size (); ++k){
+    double victim = 0, all = 0;
+    size_t runs = 0;
+    for (size_t i = 0; i < loads; ++i){
+      const ExperimentResult &r = results[k * loads + i];
+      if (r.delay.empty ()){
+        continue;
+      }
+      victim += r.delay[0];
+      all += std::accumulate (r.delay.begin (), r.delay.end (), 0.0) / r.delay.size ();
+      runs++;
+    }
+    std::cout << names[k] << ": mean delay " << std::setprecision (3) << (runs ? 1e3 * victim / runs : 0)
+              << " ms at the victim, " << (runs ? 1e3 * all / runs : 0) << " ms over all pairs" << std::endl;
+  }
+  return 0;
+}
+
+/* Labelled runs for the cascade-onset detector: every load of the grid with
+ * the attacker, replicated, and optionally the same loads without it. Each run
+ * gives a negative sample before the attack start and a sample labelled with
+ * the cascade verdict after it; the peak CUSUM statistic is the score of the
+ * ROC curve, at the victim's sender alone and as the highest of any sender.
+ */
+static int DetectorMain (int argc, char **argv){
+  SweepOptions opt;
+  GridOptions grid;
+  uint32_t replications = 3;
+  bool controls = true;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  AddGridArgs (cmd, grid);
+  cmd.AddValue ("replications", "Runs per load, with different RNG runs", replications);
+  cmd.AddValue ("controls", "Also run every load without the attacker", controls);
+  cmd.Parse (argc, argv);
+
+  // 1. Labelled runs
+  std::vector<double> rhos = Range (grid.rhoMin, grid.rhoMax, grid.rhoStep);
+  std::vector<ExperimentConfig> configs;
+  for (int attacker = 1; attacker >= (controls ? 0 : 1); --attacker){
+    for (size_t i = 0; i < rhos.size (); ++i){
+      for (uint32_t k = 0; k < replications; ++k){
+        ExperimentConfig c = opt.base;
+        c.detect = true;
+        c.restNodeLoad = rhos[i];
+        c.firstNodeLoad = attacker ? opt.base.firstNodeLoad : 0;
+        c.run = opt.base.run + k;
+        configs.push_back (c);
+      }
+    }
+  }
+  std::vector<ExperimentResult> results = RunBatch (opt, configs);
+
+  // 2. Samples: score of the victim's sender and of any sender, and the label
+  std::vector<double> victimScore, anyScore;
+  std::vector<bool> label;
+  std::vector<double> latency;
+  size_t cascades = 0, falseAlarms = 0, unlabelled = 0;
+  std::ofstream runs (OutputPath ("detector-runs.csv").c_str ());
+  runs << "u0,rho,run,cascade,victimPrePeak,victimPeak,anyPrePeak,anyPeak,alarm\n";
+  for (size_t i = 0; i < results.size (); ++i){
+    const ExperimentResult &r = results[i];
+    if (r.detectorPeak.empty () || !HasVerdict (r)){
+      // no label for a failed or stopped run
+      unlabelled++;
+      continue;
+    }
+    bool cascade = IsCascade (r, opt.tolerance);
+    double anyPre = *std::max_element (r.detectorPrePeak.begin (), r.detectorPrePeak.end ());
+    double anyPeak = *std::max_element (r.detectorPeak.begin (), r.detectorPeak.end ());
+    victimScore.push_back (r.detectorPrePeak[0]);
+    anyScore.push_back (anyPre);
+    label.push_back (false);
+    victimScore.push_back (r.detectorPeak[0]);
+    anyScore.push_back (anyPeak);
+    label.push_back (cascade);
+    double alarm = r.alarm[0];
+    cascades += cascade;
+    if (alarm >= 0 && (alarm < r.config.attackStart || !cascade)){
+      falseAlarms++;
+    }else if (alarm >= 0){
+      latency.push_back (alarm - r.config.attackStart);
+    }
+    runs << r.config.firstNodeLoad << "," << r.config.restNodeLoad << "," << r.config.run << "," << cascade << ","
+         << r.detectorPrePeak[0] << "," << r.detectorPeak[0] << "," << anyPre << "," << anyPeak << "," << alarm << "\n";
+  }
+
+  // 3. ROC curves and the operating point of the configured alarm level
+  std::ofstream roc (OutputPath ("detector-roc.csv").c_str ());
+  roc << "detector,threshold,tpr,fpr\n";
+  std::vector<RocPoint> victimRoc = RocCurve (victimScore, label);
+  std::vector<RocPoint> anyRoc = RocCurve (anyScore, label);
+  for (size_t i = 0; i < victimRoc.size (); ++i){
+    roc << "victim," << victimRoc[i].threshold << "," << victimRoc[i].tpr << "," << victimRoc[i].fpr << "\n";
+  }
+  for (size_t i = 0; i < anyRoc.size (); ++i){
+    roc << "any," << anyRoc[i].threshold << "," << anyRoc[i].tpr << "," << anyRoc[i].fpr << "\n";
+  }
+  std::sort (latency.begin (), latency.end ());
+  std::cout << "detector: " << results.size () << " runs, " << cascades << " cascades, " << unlabelled
+            << " without a verdict" << std::endl
+            << "  ROC area: victim's sender " << std::setprecision (3) << RocArea (victimRoc)
+            << ", any sender " << RocArea (anyRoc) << std::endl
+            << "  at alarm level " << opt.base.detectorThreshold << ": detected " << latency.size () << " of " << cascades
+            << " cascades, " << falseAlarms << " runs with a false alarm at the victim's sender" << std::endl;
+  if (!latency.empty ()){
+    std::cout << "  latency after the attack start: median " << latency[latency.size () / 2] << " s, mean "
+              << std::accumulate (latency.begin (), latency.end (), 0.0) / latency.size () << " s, max " << latency.back ()
+              << " s" << std::endl;
+  }
+  return 0;
+}
+
+/* Cheapest attacker traffic reaching a target collapse of the victim pair.
+ * Every burst pattern (period, packet length) and the Poisson attacker of the
+ * paper get a bisection over their intensity, the duty cycle or FirstNodeLoad,
+ * assuming the collapse grows with it; all patterns of a bisection step run
+ * as one batch. The cost of a pattern is the airtime its attacker actually
+ * transmits at the lowest intensity that reaches the target.
+ */
+static int AttackSearchMain (int argc, char **argv){
+  SweepOptions opt;
+  double collapse = 0.5;
+  std::string periods = "0.005,0.02,0.1,0.5";
+  std::string lengths = "200,1500";
+  uint32_t bisections = 5;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("collapse", "Target shortfall of the victim's normalized throughput", collapse);
+  cmd.AddValue ("periods", "Comma-separated burst periods to search (s)", periods);
+  cmd.AddValue ("attackPktLengths", "Comma-separated attacker packet lengths to search (bytes)", lengths);
+  cmd.AddValue ("bisections", "Bisection steps over the intensity of every pattern", bisections);
+  cmd.Parse (argc, argv);
+
+  std::replace (periods.begin (), periods.end (), ',', ';');
+  std::replace (lengths.begin (), lengths.end (), ',', ';');
+  std::vector<double> period = SplitValues (periods);
+  std::vector<double> length = SplitValues (lengths);
+  std::vector<std::string> names (1, "poisson");
+  std::vector<ExperimentConfig> patterns (1, opt.base);
+  patterns[0].attackPattern = "poisson";
+  for (size_t p = 0; p < period.size (); ++p){
+    for (size_t l = 0; l < length.size (); ++l){
+      std::ostringstream name;
+      name << "burst-" << period[p] << "s-" << length[l] << "B";
+      ExperimentConfig c = opt.base;
+      c.attackPattern = "burst";
+      c.burstPeriod = period[p];
+      c.attackPktLength = (uint16_t)length[l];
+      names.push_back (name.str ());
+      patterns.push_back (c);
+    }
+  }
+
+  // 1. Full intensity first: patterns that cannot reach the target drop out
+  std::vector<double> lo (patterns.size (), 0), hi (patterns.size (), 1);
+  std::vector<ExperimentResult> best (patterns.size ());
+  std::vector<bool> feasible (patterns.size (), false), active (patterns.size (), true);
+  std::ofstream out (OutputPath ("attack-search.csv").c_str ());
+  out << "pattern,intensity,victim,airtime,reached\n";
+  for (uint32_t step = 0; step <= bisections; ++step){
+    std::vector<ExperimentConfig> configs;
+    std::vector<size_t> owner;
+    std::vector<double> intensity;
+    for (size_t k = 0; k < patterns.size (); ++k){
+      if (!active[k]){
+        continue;
+      }
+      double x = step == 0 ? 1 : (lo[k] + hi[k]) / 2;
+      ExperimentConfig c = patterns[k];
+      if (c.attackPattern == "burst"){
+        c.burstDuty = x;
+      }else{
+        c.firstNodeLoad = x;
+      }
+      configs.push_back (c);
+      owner.push_back (k);
+      intensity.push_back (x);
+    }
+    if (configs.empty ()){
+      break;
+    }
+    std::vector<ExperimentResult> results = RunBatch (opt, configs);
+
+    // 2. Bisect towards the lowest intensity that still reaches the target
+    for (size_t i = 0; i < results.size (); ++i){
+      size_t k = owner[i];
+      double victim = NormalizedThroughput (results[i], 0);
+      bool reached = victim <= 1 - collapse;
+      if (!HasVerdict (results[i])){
+        // neither side of the bisection: stop searching this pattern, keeping what it found
+        out << names[k] << "," << intensity[i] << ",," << results[i].attackAirtime << ",-1\n";
+        std::cerr << "attack-search: " << names[k] << " at " << intensity[i] << " has no verdict, search stopped" << std::endl;
+        active[k] = false;
+        continue;
+      }
+      out << names[k] << "," << intensity[i] << "," << victim << "," << results[i].attackAirtime << "," << reached << "\n";
+      if (reached){
+        hi[k] = intensity[i];
+        best[k] = results[i];
+        feasible[k] = true;
+      }else if (step == 0){
+        active[k] = false;
+      }else{
+        lo[k] = intensity[i];
+      }
+    }
+  }
+
+  // 3. Patterns by the airtime their attacker needs
+  std::vector<size_t> order;
+  for (size_t k = 0; k < patterns.size (); ++k){
+    if (feasible[k]){
+      order.push_back (k);
+    }
+  }
+  std::sort (order.begin (), order.end (), [&best] (size_t a, size_t b){
+    return best[a].attackAirtime < best[b].attackAirtime;
+  });
+  std::cout << "attack-search: victim normalized throughput at most " << 1 - collapse << std::endl
+            << std::setw (24) << "pattern" << std::setw (12) << "intensity" << std::setw (12) << "victim" << std::setw (12) << "airtime" << std::endl;
+  for (size_t i = 0; i < order.size (); ++i){
+    size_t k = order[i];
+    std::cout << std::setw (24) << names[k] << std::setw (12) << hi[k] << std::setw (12) << NormalizedThroughput (best[k], 0)
+              << std::setw (12) << best[k].attackAirtime << std::endl;
+  }
+  for (size_t k = 0; k < patterns.size (); ++k){
+    if (!feasible[k]){
+      std::cout << std::setw (24) << names[k] << "  does not reach the target" << std::endl;
+    }
+  }
+  return order.empty () ? 1 : 0;
+}
+
+/* Monte Carlo estimate of the probability that a random deployment of the
+ * pairs in the building is vulnerable to a cascade (cdos-deployment.h). A
+ * simulated layout is vulnerable when a pair the attacker does not hit
+ * directly can no longer deliver its load.
+ */
+static int DeploymentMain (int argc, char **argv){
+  SweepOptions opt;
+  DeploymentOptions dep;
+  LinkBudget budget;
+  uint32_t samples = 1000;
+  uint32_t maxSimulated = 200;
+  uint32_t audit = 20;
+  uint32_t sampleSeed = 1;
+  double z = 1.96;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("samples", "Random deployments to screen", samples);
+  cmd.AddValue ("pairs", "Sender/receiver pairs per deployment, the last one attacks", dep.pairs);
+  cmd.AddValue ("roomRange", "Rooms between a sender and its receiver along each axis", dep.roomRange);
+  cmd.AddValue ("sampleSeed", "Seed of the deployment sampler", sampleSeed);
+  cmd.AddValue ("maxSimulated", "Flagged deployments to simulate at most", maxSimulated);
+  cmd.AddValue ("audit", "Deployments screened as safe to simulate as well", audit);
+  cmd.AddValue ("z", "Width of the confidence intervals in standard errors", z);
+  cmd.Parse (argc, argv);
+  budget.txPower = SplitValues (opt.base.txPower);
+  budget.ccaThreshold = SplitValues (opt.base.ccaThreshold);
+
+  FloorPlan plan;
+  plan.wallLoss = opt.base.wallLoss;
+  std::string error;
+  if (!opt.base.floorPlan.empty () && !LoadFloorPlan (opt.base.floorPlan, plan, error)){
+    NS_FATAL_ERROR (error);
+  }
+  if (!plan.measured.empty ()){
+    std::cerr << "deployment: the measured losses of " << opt.base.floorPlan << " belong to its own node positions" << std::endl;
+  }
+  DeploymentSampler sampler (plan, dep);
+  std::mt19937 rng (sampleSeed);
+  size_t attacker = dep.pairs - 1;
+
+  // 1. Screen random layouts, redrawing those where some receiver cannot decode its sender at all
+  std::vector<std::string> layouts;
+  std::vector<bool> flagged;
+  std::vector<std::vector<bool> > direct;
+  size_t rejected = 0;
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  while (layouts.size () < samples && rejected < 10 * (size_t)samples){
+    ExperimentConfig c = opt.base;
+    c.numofNode = 2 * dep.pairs;
+    c.layout = FormatLayout (sampler.Sample (rng));
+    LossMatrix loss = ComputeLossMatrix (CreateTopology (c));
+    Simulator::Destroy ();
+    TopologyAnalyser analyser (loss, budget);
+    bool decodable = true;
+    for (size_t f = 0; f < analyser.GetFlows (); ++f){
+      decodable = decodable && analyser.CanDecode (f);
+    }
+    if (!decodable){
+      rejected++;
+      continue;
+    }
+    std::vector<bool> hit (dep.pairs, false);
+    for (size_t f = 0; f < dep.pairs; ++f){
+      hit[f] = f == attacker || analyser.Hits (attacker, f);
+    }
+    layouts.push_back (c.layout);
+    flagged.push_back (StartsCascade (analyser, attacker));
+    direct.push_back (hit);
+  }
+  double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - begin).count ();
+
+  // 2. Simulate the flagged layouts and an audit sample of the others
+  std::vector<ExperimentConfig> configs;
+  std::vector<size_t> owner;
+  size_t nFlagged = std::count (flagged.begin (), flagged.end (), true);
+  size_t simulated = 0, audited = 0;
+  for (size_t i = 0; i < layouts.size (); ++i){
+    if (flagged[i] ? simulated >= maxSimulated : audited >= audit){
+      continue;
+    }
+    (flagged[i] ? simulated : audited)++;
+    ExperimentConfig c = opt.base;
+    c.numofNode = 2 * dep.pairs;
+    c.layout = layouts[i];
+    configs.push_back (c);
+    owner.push_back (i);
+  }
+  std::vector<ExperimentResult> results = RunBatch (opt, configs);
+
+  // 3. Verdicts and the estimate
+  size_t cascades = 0, missed = 0;
+  std::ofstream out (OutputPath ("deployment.csv").c_str ());
+  out << "sample,flagged,cascade,layout\n";
+  for (size_t k = 0; k < results.size (); ++k){
+    size_t i = owner[k];
+    if (!HasVerdict (results[k])){
+      // the sample drops out of the estimate
+      (flagged[i] ? simulated : audited)--;
+      out << i << "," << flagged[i] << ",-1," << layouts[i] << "\n";
+      continue;
+    }
+    bool cascade = false;
+    for (size_t f = 0; f < dep.pairs; ++f){
+      cascade = cascade || (!direct[i][f] && NormalizedThroughput (results[k], f) < 1 - opt.tolerance);
+    }
+    (flagged[i] ? cascades : missed) += cascade;
+    out << i << "," << flagged[i] << "," << cascade << "," << layouts[i] << "\n";
+  }
+  CascadeEstimate e = EstimateCascadeProbability (layouts.size (), nFlagged, simulated, cascades, audited, missed, z);
+  std::cout << "deployment: " << layouts.size () << " layouts of " << dep.pairs << " pairs screened in " << ms << " ms ("
+            << rejected << " redrawn with an undecodable link), " << nFlagged << " flagged" << std::endl
+            << "  simulated " << simulated << " flagged: " << cascades << " cascade; audited " << audited << " unflagged: "
+            << missed << " cascade" << std::endl
+            << "  P(vulnerable) = " << std::setprecision (3) << e.p << ", interval [" << e.lower << ", " << e.upper << "] at z = " << z
+            << std::endl;
+  return 0;
+}
+
+/* Checks and times the batch loss matrix against the building model on a
+ * random layout of many nodes: the model pair by pair, the scalar batch, the
+ * vectorised batch and the vectorised batch on threads. Exits with 1 when the
+ * batch deviates from the model by more than the allowed error.
+ */
+static int LossBatchMain (int argc, char **argv){
+  SweepOptions opt;
+  uint32_t nodes = 1000;
+  uint32_t threads = DefaultWorkers ();
+  double maxError = 1e-6;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("batchNodes", "Nodes of the random layout", nodes);
+  cmd.AddValue ("threads", "Threads of the batch", threads);
+  cmd.AddValue ("maxError", "Largest accepted deviation from the model (dB)", maxError);
+  cmd.Parse (argc, argv);
+
+  FloorPlan plan;
+  plan.wallLoss = opt.base.wallLoss;
+  std::string error;
+  if (!opt.base.floorPlan.empty () && !LoadFloorPlan (opt.base.floorPlan, plan, error)){
+    NS_FATAL_ERROR (error);
+  }
+  DeploymentOptions dep;
+  dep.pairs = (nodes + 1) / 2;
+  std::mt19937 rng (opt.base.seed);
+  ExperimentConfig c = opt.base;
+  c.layout = FormatLayout (DeploymentSampler (plan, dep).Sample (rng));
+  c.numofNode = (uint16_t)std::min<uint32_t> (nodes, 65535);
+  Topology topology = CreateTopology (c);
+  size_t n = topology.mobility.size ();
+
+  // 1. Reference: the model for every pair, without shadowing
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  LossMatrix reference (n, std::vector<double> (n, 0));
+  for (size_t i = 0; i < n; ++i){
+    for (size_t j = 0; j < n; ++j){
+      if (i != j){
+        reference[i][j] = topology.building->GetLoss (topology.mobility[i], topology.mobility[j]);
+      }
+    }
+  }
+  double modelMs = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - begin).count ();
+
+  // 2. The batch variants
+  LossBatch batch (topology.geometry, topology.positions);
+  const char *names[3] = {"scalar", "simd", "simd-threads"};
+  bool simd[3] = {false, true, true};
+  unsigned pool[3] = {1, 1, threads};
+  std::cout << "loss-batch: " << n << " nodes, " << n * (n - 1) << " pairs, model " << modelMs << " ms"
+            << (LossBatch::HasSimd () ? "" : " (no AVX2: simd runs the scalar loop)") << std::endl;
+  double worst = 0;
+  for (int k = 0; k < 3; ++k){
+    begin = std::chrono::steady_clock::now ();
+    LossMatrix loss = batch.Matrix (pool[k], simd[k]);
+    double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - begin).count ();
+    double deviation = 0;
+    size_t outside = 0;
+    for (size_t i = 0; i < n; ++i){
+      for (size_t j = 0; j < n; ++j){
+        if (std::isnan (loss[i][j])){
+          outside++;
+        }else{
+          deviation = std::max (deviation, std::fabs (loss[i][j] - reference[i][j]));
+        }
+      }
+    }
+    worst = std::max (worst, deviation);
+    std::cout << "  " << std::setw (14) << names[k] << ": " << std::setw (10) << ms << " ms (" << std::setprecision (3)
+              << (ms > 0 ? modelMs / ms : 0) << "x), max deviation " << deviation << " dB, " << outside
+              << " pairs left to the model" << std::setprecision (6) << std::endl;
+  }
+  Simulator::Destroy ();
+  return worst > maxError ? 1 : 0;
+}
+
+/* Job startup of the plain forked workers against the zygote, on many short
+ * runs that are not recorded in the store: the latency from dispatch to the
+ * start of the job in its child, the time the job itself takes (which holds
+ * the first-run set-up in a plain child) and the throughput.
+ */
+static int ZygoteBenchMain (int argc, char **argv){
+  SweepOptions opt;
+  uint32_t jobs = 2000;
+  uint32_t jobDuration = 1;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("jobs", "Short runs per worker kind", jobs);
+  cmd.AddValue ("jobDuration", "Simulated time of a short run (s)", jobDuration);
+  cmd.Parse (argc, argv);
+
+  ExperimentConfig c = opt.base;
+  c.durationofSimulation = (uint16_t)std::max<uint32_t> (jobDuration, 1);
+  c.attackStart = c.durationofSimulation / 2.0;
+  c.attackStop = c.durationofSimulation;
+  c.enableAthstats = false;
+  c.progressSocket = "";
+  SweepJob job = [&c] (size_t i){
+    ExperimentConfig run = c;
+    run.run = c.run + (uint32_t)i;
+    return FormatResult (experiment (run));
+  };
+
+  std::cout << "zygote-bench: " << jobs << " runs of " << c.durationofSimulation << " simulated s on " << opt.workers
+            << " workers" << std::endl
+            << std::setw (10) << "workers" << std::setw (14) << "runs/s" << std::setw (16) << "latency ms" << std::setw (12)
+            << "p99 ms" << std::setw (14) << "run ms" << std::setw (10) << "failed" << std::endl;
+  for (int zygote = 0; zygote <= 1; ++zygote){
+    JobTimes times;
+    double begin = MonotonicSeconds ();
+    std::vector<std::string> lines = zygote
+      ? RunZygote (jobs, opt.workers, job, [&c] (){ WarmUp (c); }, std::vector<size_t> (), &times)
+      : RunForked (jobs, opt.workers, job, std::vector<size_t> (), std::function<bool ()> (), 1, &times);
+    double wall = MonotonicSeconds () - begin;
+    size_t failed = std::count (lines.begin (), lines.end (), std::string ());
+    std::vector<double> latency = times.latency;
+    std::sort (latency.begin (), latency.end ());
+    double runtime = std::accumulate (times.runtime.begin (), times.runtime.end (), 0.0) / std::max<size_t> (jobs, 1);
+    std::cout << std::setw (10) << (zygote ? "zygote" : "forked") << std::setw (14) << std::setprecision (4) << jobs / wall
+              << std::setw (16) << (latency.empty () ? 0 : 1e3 * latency[latency.size () / 2])
+              << std::setw (12) << (latency.empty () ? 0 : 1e3 * latency[latency.size () * 99 / 100])
+              << std::setw (14) << 1e3 * runtime << std::setw (10) << failed << std::endl;
+  }
+  return 0;
+}
+
+/* Hardware counters of the setup, the event loop and the teardown of the base
+ * scenario, averaged over --repeats runs with consecutive run numbers, in
+ * total and per packet the applications sent. The runs are recorded in the
+ * store with their counters, so later optimisations can be compared against
+ * them.
+ */
+static int PerfMain (int argc, char **argv){
+  SweepOptions opt;
+  uint32_t repeats = 3;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("repeats", "Runs of the base scenario", repeats);
+  cmd.Parse (argc, argv);
+
+  std::vector<ExperimentConfig> configs;
+  for (uint32_t i = 0; i < std::max<uint32_t> (repeats, 1); ++i){
+    ExperimentConfig c = opt.base;
+    c.run = opt.base.run + i;
+    c.perfCounters = true;
+    configs.push_back (c);
+  }
+  std::vector<ExperimentResult> results = RunBatch (opt, configs);
+
+  // mean of every counter over the runs that have it
+  const char *phases[3] = {"setup", "run", "teardown"};
+  double sum[3][PERF_COUNTERS] = {}, perPacket[3][PERF_COUNTERS] = {};
+  size_t counted[3][PERF_COUNTERS] = {};
+  double packets = 0, wallTime = 0;
+  size_t runs = 0;
+  for (size_t i = 0; i < results.size (); ++i){
+    const ExperimentResult &r = results[i];
+    if (r.throughput.empty ()){
+      continue;
+    }
+    runs++;
+    packets += r.packets;
+    wallTime += r.wallTime;
+    const std::vector<double> *phase[3] = {&r.perfSetup, &r.perfRun, &r.perfTeardown};
+    for (int p = 0; p < 3; ++p){
+      for (int k = 0; k < PERF_COUNTERS && k < (int)phase[p]->size (); ++k){
+        if ((*phase[p])[k] >= 0){
+          sum[p][k] += (*phase[p])[k];
+          perPacket[p][k] += r.packets ? (*phase[p])[k] / r.packets : 0;
+          counted[p][k]++;
+        }
+      }
+    }
+  }
+  std::cout << "perf: " << runs << " runs of " << opt.base.durationofSimulation << " simulated s, "
+            << (runs ? packets / runs : 0) << " packets and " << (runs ? wallTime / runs : 0) << " s per run" << std::endl;
+  bool available = false;
+  for (int k = 0; k < PERF_COUNTERS; ++k){
+    available = available || counted[1][k] > 0;
+  }
+  if (!available){
+    std::cout << "perf: no hardware counters available (perf_event_paranoid, or no PMU in this machine)" << std::endl;
+    return 0;
+  }
+  std::cout << std::setw (10) << "phase";
+  for (int k = 0; k < PERF_COUNTERS; ++k){
+    std::cout << std::setw (16) << PerfCounterName (k);
+  }
+  std::cout << std::setw (8) << "IPC";
+  for (int k = 0; k < PERF_COUNTERS; ++k){
+    std::cout << std::setw (16) << std::string (PerfCounterName (k)) + "/pkt";
+  }
+  std::cout << std::endl;
+  for (int p = 0; p < 3; ++p){
+    std::cout << std::setw (10) << phases[p] << std::setprecision (4);
+    for (int k = 0; k < PERF_COUNTERS; ++k){
+      if (counted[p][k]){
+        std::cout << std::setw (16) << sum[p][k] / counted[p][k];
+      }else{
+        std::cout << std::setw (16) << "-";
+      }
+    }
+    if (counted[p][PERF_CYCLES] && counted[p][PERF_INSTRUCTIONS] && sum[p][PERF_CYCLES] > 0){
+      std::cout << std::setw (8) << sum[p][PERF_INSTRUCTIONS] / sum[p][PERF_CYCLES];
+    }else{
+      std::cout << std::setw (8) << "-";
+    }
+    for (int k = 0; k < PERF_COUNTERS; ++k){
+      if (counted[p][k]){
+        std::cout << std::setw (16) << perPacket[p][k] / counted[p][k];
+      }else{
+        std::cout << std::setw (16) << "-";
+      }
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
+
+/* Applies overrides "name=value,..." to a scenario: any result store field of
+ * the configuration, scheduler, and runner (forked, zygote or ring) for the
+ * way the runs are executed. Returns false on an unknown name.
+ */
+static bool ApplyOverrides (const std::string &overrides, ExperimentConfig &config, SweepOptions &opt){
+  std::vector<std::pair<std::string, std::string> > fields = ResultFields (ExperimentResult ());
+  std::istringstream is (overrides);
+  std::string item;
+  // list values such as layouts use ';' themselves
+  while (std::getline (is, item, ',')){
+    if (item.empty ()){
+      continue;
+    }
+    std::string name = item.substr (0, item.find ('='));
+    std::string value = item.find ('=') == std::string::npos ? "1" : item.substr (item.find ('=') + 1);
+    bool known = false;
+    for (size_t i = 0; i < fields.size () && fields[i].first != "throughput"; ++i){
+      known = known || fields[i].first == name;
+    }
+    if (name == "scheduler"){
+      config.scheduler = value;
+    }else if (name == "runner" && (value == "forked" || value == "zygote" || value == "ring")){
+      opt.zygote = value == "zygote";
+      opt.ring = value == "ring";
+    }else if (known){
+      ExperimentResult r;
+      r.config = config;
+      SetResultField (r, name, value);
+      config = r.config;
+    }else{
+      std::cerr << "determinism: unknown override " << item << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Runs the base scenario on a reference and an optimised path with the same
+ * seeds and run numbers. By default every run must be bit-exact: the hash of
+ * its ordered MAC/PHY events and its final counters must match, and for a run
+ * that differs the event logs are streamed to the first divergent event. With
+ * --approx the paths only need to agree statistically over the runs. Returns
+ * 1 when the paths are not equivalent.
+ */
+static int DeterminismMain (int argc, char **argv){
+  SweepOptions opt;
+  std::string reference;
+  std::string optimised;
+  uint32_t runs = 0;
+  bool approx = false;
+  double z = 3;
+  double relTolerance = 0.02;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("reference", "Overrides of the reference path: name=value,... (store fields, scheduler, runner)", reference);
+  cmd.AddValue ("optimised", "Overrides of the optimised path, same format", optimised);
+  cmd.AddValue ("runs", "Run numbers to compare, 0 for 1 (bit-exact) or 10 (--approx)", runs);
+  cmd.AddValue ("approx", "Accept statistically equivalent results instead of bit-exact ones", approx);
+  cmd.AddValue ("z", "--approx: standard errors of the difference accepted", z);
+  cmd.AddValue ("relTolerance", "--approx: relative difference of the means accepted on top", relTolerance);
+  cmd.Parse (argc, argv);
+  runs = runs ? runs : (approx ? 10 : 1);
+
+  // 1. Same runs on both paths, with event logs unless only the statistics count
+  const char *sides[2] = {"reference", "optimised"};
+  std::vector<ExperimentResult> results[2];
+  for (int side = 0; side < 2; ++side){
+    SweepOptions sideOpt = opt;
+    ExperimentConfig base = opt.base;
+    if (!ApplyOverrides (side ? optimised : reference, base, sideOpt)){
+      return 1;
+    }
+    std::vector<ExperimentConfig> configs;
+    for (uint32_t i = 0; i < runs; ++i){
+      ExperimentConfig c = base;
+      c.run = opt.base.run + i;
+      c.enableAthstats = false;
+      c.traceEvents = true;
+      if (!approx){
+        std::ostringstream log;
+        log << "determinism-" << sides[side] << "-" << c.run << ".events";
+        c.eventLog = OutputPath (log.str ());
+      }
+      configs.push_back (c);
+    }
+    results[side] = RunBatch (sideOpt, configs);
+  }
+
+  bool equivalent = true;
+  if (!approx){
+    // 2. Bit-exact: event hash and count, then the final counters
+    for (uint32_t i = 0; i < runs; ++i){
+      const ExperimentResult &a = results[0][i], &b = results[1][i];
+      std::vector<std::pair<std::string, std::string> > diff = DiffCounters (a, b);
+      if (a.throughput.empty () || b.throughput.empty ()){
+        std::cout << "run " << a.config.run << ": failed on the " << (a.throughput.empty () ? "reference" : "optimised") << " path" << std::endl;
+        equivalent = false;
+        continue;
+      }
+      if (diff.empty ()){
+        std::cout << "run " << a.config.run << ": identical, " << a.events << " events, hash " << std::hex << a.eventHash
+                  << std::dec << std::endl;
+        std::remove (a.config.eventLog.c_str ());
+        std::remove (b.config.eventLog.c_str ());
+        continue;
+      }
+      equivalent = false;
+      std::cout << "run " << a.config.run << ": diverged" << std::endl;
+      if (a.eventHash != b.eventHash || a.events != b.events){
+        Divergence d = FirstDivergence (a.config.eventLog, b.config.eventLog);
+        std::cout << "  first divergent event #" << d.index << ": reference "
+                  << (d.hasA ? FormatTraceEvent (d.a) : std::string ("(end of log)")) << ", optimised "
+                  << (d.hasB ? FormatTraceEvent (d.b) : std::string ("(end of log)")) << std::endl
+                  << "  logs kept in " << a.config.eventLog << " and " << b.config.eventLog << std::endl;
+      }
+      for (size_t k = 0; k < diff.size (); ++k){
+        std::cout << "  " << diff[k].first << ": " << diff[k].second << std::endl;
+      }
+    }
+  }else{
+    // 3. Statistical: means of the outcome over the runs
+    const char *metrics[5] = {"victim", "total", "txFailure", "phyEvents", "cascade"};
+    std::vector<double> samples[2][5];
+    for (int side = 0; side < 2; ++side){
+      for (size_t i = 0; i < results[side].size (); ++i){
+        const ExperimentResult &r = results[side][i];
+        if (!HasVerdict (r)){
+          continue;
+        }
+        samples[side][0].push_back (NormalizedThroughput (r, 0));
+        samples[side][1].push_back (TotalThroughput (r));
+        samples[side][2].push_back (r.txFailure.empty () ? 0
+                                    : std::accumulate (r.txFailure.begin (), r.txFailure.end (), 0.0) / r.txFailure.size ());
+        samples[side][3].push_back ((double)r.phyEvents);
+        samples[side][4].push_back (IsCascade (r, opt.tolerance));
+      }
+    }
+    std::cout << std::setw (12) << "metric" << std::setw (14) << "reference" << std::setw (14) << "optimised"
+              << std::setw (14) << "bound" << std::setw (12) << "verdict" << std::endl;
+    for (int m = 0; m < 5; ++m){
+      MeanComparison c = EquivalentMeans (samples[0][m], samples[1][m], z, relTolerance);
+      equivalent = equivalent && c.equivalent;
+      std::cout << std::setw (12) << metrics[m] << std::setprecision (6) << std::setw (14) << c.meanA << std::setw (14)
+                << c.meanB << std::setw (14) << c.bound << std::setw (12) << (c.equivalent ? "ok" : "DIFFERENT") << std::endl;
+    }
+    std::cout << "over " << samples[0][0].size () << " reference and " << samples[1][0].size () << " optimised runs" << std::endl;
+  }
+  std::cout << "determinism: " << (equivalent ? "equivalent" : "NOT equivalent") << (approx ? " (statistically)" : " (bit-exact)")
+            << std::endl;
+  return equivalent ? 0 : 1;
+}
+
+// Screens a layout for hidden terminals and cascade chains without simulating it.
+static int TopologyMain (int argc, char **argv){
+  SweepOptions opt;
+  LinkBudget budget;
+  CommandLine cmd;
+  AddSweepArgs (cmd, opt);
+  cmd.AddValue ("txPower", "Transmit power of every node (dBm)", budget.defaultTxPower);
+  cmd.AddValue ("ccaThreshold", "CCA mode 1 threshold of every node (dBm)", budget.defaultCcaThreshold);
+  cmd.AddValue ("sinrThreshold", "SINR needed to decode a data frame (dB)", budget.sinrThreshold);
+  cmd.Parse (argc, argv);
+  budget.txPower = SplitValues (opt.base.txPower);
+  budget.ccaThreshold = SplitValues (opt.base.ccaThreshold);
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  LossMatrix loss = ComputeLossMatrix (CreateTopology (opt.base));
+  TopologyAnalyser analyser (loss, budget);
+  std::string report = analyser.Describe ();
+  double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - begin).count ();
+  Simulator::Destroy ();
+
+  std::cout << "received power (dBm), row transmits:" << std::endl;
+  for (size_t i = 0; i < loss.size (); ++i){
+    for (size_t j = 0; j < loss.size (); ++j){
+      std::cout << std::setw (8) << std::fixed << std::setprecision (1) << (i == j ? 0.0 : analyser.RxPower (i, j));
+    }
+    std::cout << std::endl;
+  }
+  std::cout << report << std::endl << "topology: " << loss.size () << " nodes screened in " << ms << " ms" << std::endl;
+  return analyser.HasCascadeChain () ? 2 : 0;
+}
+
+int main (int argc, char **argv){
+  std::string mode = GetMode (argc, argv);
+  if (mode == "phase-map"){
+    return PhaseMapMain (argc, argv);
+  }
+  if (mode == "multi-fidelity"){
+    return MultiFidelityMain (argc, argv);
+  }
+  if (mode == "surrogate"){
+    return SurrogateMain (argc, argv);
+  }
+  if (mode == "sobol"){
+    return SobolMain (argc, argv);
+  }
+  if (mode == "queue-submit"){
+    return QueueSubmitMain (argc, argv);
+  }
+  if (mode == "queue-worker"){
+    return QueueWorkerMain (argc, argv);
+  }
+  if (mode == "dashboard"){
+    return DashboardMain (argc, argv);
+  }
+  if (mode == "topology"){
+    return TopologyMain (argc, argv);
+  }
+  if (mode == "fragmentation"){
+    return FragmentationMain (argc, argv);
+  }
+  if (mode == "txop"){
+    return TxopMain (argc, argv);
+  }
+  if (mode == "cw-control"){
+    return CwControlMain (argc, argv);
+  }
+  if (mode == "power-tuning"){
+    return PowerTuningMain (argc, argv);
+  }
+  if (mode == "channels"){
+    return ChannelsMain (argc, argv);
+  }
+  if (mode == "shaper"){
+    return ShaperMain (argc, argv);
+  }
+  if (mode == "mac-queue"){
+    return MacQueueMain (argc, argv);
+  }
+  if (mode == "detector"){
+    return DetectorMain (argc, argv);
+  }
+  if (mode == "attack-search"){
+    return AttackSearchMain (argc, argv);
+  }
+  if (mode == "deployment"){
+    return DeploymentMain (argc, argv);
+  }
+  if (mode == "loss-batch"){
+    return LossBatchMain (argc, argv);
+  }
+  if (mode == "zygote-bench"){
+    return ZygoteBenchMain (argc, argv);
+  }
+  if (mode == "perf"){
+    return PerfMain (argc, argv);
+  }
+  if (mode == "determinism"){
+    return DeterminismMain (argc, argv);
+  }
+  if (!mode.empty () && mode != "paper"){
+    std::cerr << "unknown mode '" << mode << "', valid modes: " << MODES << std::endl;
+    return 1;
+  }
+
   RngSeedManager::SetSeed(1);
   uint16_t numofnode = 6;
   uint16_t durationofsimulation = 203;
@@ -0,0 +1,36 @@
+/* Frame durations at the rates of the scenario, shared by the airtime
+ * shaper and the TXOP sizing.
+ *
+ * Data frames go out at ERP-OFDM 6 Mbps: 20 us of preamble and header, then
+ * 4 us symbols of 24 data bits carrying the 16-bit SERVICE field, the frame
+ * and 6 tail bits, then the 6 us signal extension of ERP. ns-3.22 sends the
+ * ACK to such a frame at the same rate, so it takes the same form. RTS and
+ * CTS go out at the DSSS 1 Mbps control rate with the long preamble.
+ */
+#ifndef CDOS_AIRTIME_H
+#define CDOS_AIRTIME_H
+
+#include <cmath>
+
+const double SLOT_US = 20;
+const double SIFS_US = 10;
+const double ACK_BYTES = 14;
+const double RTS_BYTES = 20;
+const double CTS_BYTES = 14;
+
+// us of an ERP-OFDM 6 Mbps frame of this many bytes (MAC header and FCS included).
+inline double ErpOfdmUs (double bytes){
+  return 20 + 4 * std::ceil ((16 + 6 + 8 * bytes) / 24) + 6;
+}
+
+// Largest frame, in bytes, that fits us at ERP-OFDM 6 Mbps.
+inline double ErpOfdmBytes (double us){
+  return std::floor ((std::floor ((us - 20 - 6) / 4) * 24 - 16 - 6) / 8);
+}
+
+// us of a DSSS 1 Mbps frame with the long preamble.
+inline double DsssLongUs (double bytes){
+  return 192 + 8 * bytes;
+}
+
+#endif /* CDOS_AIRTIME_H */
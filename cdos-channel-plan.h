@@ -0,0 +1,171 @@
+/* Channel assignment of the sender/receiver pairs by graph colouring.
+ *
+ * Two flows conflict when a node of one can sense a node of the other or when
+ * either sender is a hidden terminal of the other flow; hidden-terminal
+ * conflicts weigh more, since they are the links of a cascade chain. Flows on
+ * different channels do not interact at all. With enough channels the plan
+ * is a proper colouring of the conflict graph (DSATUR order); with fewer, a
+ * greedy assignment followed by single-flow moves minimises the weight of the
+ * conflicts left on shared channels.
+ */
+#ifndef CDOS_CHANNEL_PLAN_H
+#define CDOS_CHANNEL_PLAN_H
+
+#include <algorithm>
+#include <set>
+#include <vector>
+#include "cdos-topology.h"
+
+class ChannelPlanner {
+public:
+  ChannelPlanner (const LossMatrix &loss, const LinkBudget &budget, double hiddenWeight = 100)
+    : m_loss (loss), m_budget (budget), m_analyser (loss, budget), m_hiddenWeight (hiddenWeight){
+    size_t flows = m_analyser.GetFlows ();
+    m_conflict.assign (flows, std::vector<double> (flows, 0));
+    for (size_t f = 0; f < flows; ++f){
+      for (size_t g = 0; g < flows; ++g){
+        if (f == g){
+          continue;
+        }
+        if (m_analyser.Hits (f, g) || m_analyser.Hits (g, f)){
+          m_conflict[f][g] = hiddenWeight;
+        }else if (Hears (f, g) || Hears (g, f)){
+          m_conflict[f][g] = 1;
+        }
+      }
+    }
+  }
+
+  size_t GetFlows () const { return m_conflict.size (); }
+  double Conflict (size_t f, size_t g) const { return m_conflict[f][g]; }
+
+  // Weight of the conflicts between flows sharing a channel.
+  double Cost (const std::vector<unsigned> &channel) const {
+    double cost = 0;
+    for (size_t f = 0; f < GetFlows (); ++f){
+      for (size_t g = f + 1; g < GetFlows (); ++g){
+        cost += channel[f] == channel[g] ? m_conflict[f][g] : 0;
+      }
+    }
+    return cost;
+  }
+
+  std::vector<unsigned> Plan (unsigned channels) const {
+    size_t flows = GetFlows ();
+    channels = std::max (channels, 1u);
+    std::vector<unsigned> channel (flows, 0);
+    std::vector<bool> done (flows, false);
+    // 1. DSATUR: next is the flow whose conflicting neighbours already use the most channels
+    for (size_t step = 0; step < flows; ++step){
+      size_t next = flows;
+      size_t bestSat = 0;
+      double bestDegree = -1;
+      for (size_t f = 0; f < flows; ++f){
+        if (done[f]){
+          continue;
+        }
+        std::set<unsigned> used;
+        double degree = 0;
+        for (size_t g = 0; g < flows; ++g){
+          if (m_conflict[f][g] > 0){
+            degree += m_conflict[f][g];
+            if (done[g]){
+              used.insert (channel[g]);
+            }
+          }
+        }
+        if (next == flows || used.size () > bestSat || (used.size () == bestSat && degree > bestDegree)){
+          next = f;
+          bestSat = used.size ();
+          bestDegree = degree;
+        }
+      }
+      // the channel adding the least conflict weight, lowest first on ties
+      double bestAdded = -1;
+      for (unsigned c = 0; c < channels; ++c){
+        double added = 0;
+        for (size_t g = 0; g < flows; ++g){
+          added += done[g] && channel[g] == c ? m_conflict[next][g] : 0;
+        }
+        if (bestAdded < 0 || added < bestAdded){
+          bestAdded = added;
+          channel[next] = c;
+        }
+      }
+      done[next] = true;
+    }
+    // 2. Move single flows while that lowers the cost
+    for (bool improved = true; improved; ){
+      improved = false;
+      for (size_t f = 0; f < flows; ++f){
+        unsigned original = channel[f];
+        double best = Cost (channel);
+        for (unsigned c = 0; c < channels; ++c){
+          channel[f] = c;
+          double cost = Cost (channel);
+          if (cost < best){
+            best = cost;
+            original = c;
+            improved = true;
+          }
+        }
+        channel[f] = original;
+      }
+    }
+    return channel;
+  }
+
+  // Longest cascade chain left when flows on different channels cannot interact.
+  size_t LongestChain (const std::vector<unsigned> &channel) const {
+    LossMatrix loss = m_loss;
+    for (size_t i = 0; i < loss.size (); ++i){
+      for (size_t j = 0; j < loss.size (); ++j){
+        if (i / 2 < channel.size () && j / 2 < channel.size () && channel[i / 2] != channel[j / 2]){
+          loss[i][j] = 1e9;
+        }
+      }
+    }
+    return TopologyAnalyser (loss, m_budget).LongestChain ();
+  }
+
+  /* Fewest channels that leave no conflict on a shared channel, counting
+   * only the hidden-terminal conflicts if hiddenOnly is set.
+   */
+  unsigned ChannelsNeeded (bool hiddenOnly) const {
+    for (unsigned k = 1; k < GetFlows (); ++k){
+      std::vector<unsigned> channel = Plan (k);
+      bool clear = true;
+      for (size_t f = 0; f < GetFlows (); ++f){
+        for (size_t g = f + 1; g < GetFlows (); ++g){
+          double w = channel[f] == channel[g] ? m_conflict[f][g] : 0;
+          clear = clear && (hiddenOnly ? w < m_hiddenWeight : w == 0);
+        }
+      }
+      if (clear){
+        return k;
+      }
+    }
+    return std::max<unsigned> (GetFlows (), 1);
+  }
+
+private:
+  // Some node of flow g can sense some node of flow f.
+  bool Hears (size_t f, size_t g) const {
+    for (size_t a = 2 * f; a <= 2 * f + 1; ++a){
+      for (size_t b = 2 * g; b <= 2 * g + 1; ++b){
+        if (m_analyser.Senses (b, a)){
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  LossMatrix m_loss;
+  LinkBudget m_budget;
+  TopologyAnalyser m_analyser;
+  double m_hiddenWeight;
+  std::vector<std::vector<double> > m_conflict;
+};
+
+#endif /* CDOS_CHANNEL_PLAN_H */
@@ -0,0 +1,72 @@
+/* CoDel drop decision (Nichols and Jacobson, RFC 8289).
+ *
+ * The queue is judged by the sojourn time of the packet at its head. Once it
+ * has stayed above the target for a whole interval, CoDel drops the head
+ * packet and keeps dropping at intervals shrinking with the square root of
+ * the number of drops, until the sojourn time falls below the target again.
+ * The caller asks for every head packet it is about to dequeue.
+ */
+#ifndef CDOS_CODEL_H
+#define CDOS_CODEL_H
+
+#include <stdint.h>
+#include <cmath>
+
+class CoDel {
+public:
+  CoDel (double target = 0.005, double interval = 0.1)
+    : m_target (target), m_interval (interval), m_firstAbove (0), m_dropNext (0),
+      m_count (0), m_lastCount (0), m_dropping (false), m_drops (0) {}
+
+  // True when the head packet, queued for sojourn seconds, is to be dropped.
+  bool ShouldDrop (double now, double sojourn, bool lastPacket){
+    bool okToDrop = false;
+    if (sojourn < m_target || lastPacket){
+      m_firstAbove = 0;
+    }else if (m_firstAbove == 0){
+      m_firstAbove = now + m_interval;
+    }else if (now >= m_firstAbove){
+      okToDrop = true;
+    }
+
+    if (m_dropping){
+      if (!okToDrop){
+        m_dropping = false;
+        return false;
+      }
+      if (now < m_dropNext){
+        return false;
+      }
+      m_count++;
+      m_dropNext = ControlLaw (m_dropNext);
+      m_drops++;
+      return true;
+    }
+    if (!okToDrop){
+      return false;
+    }
+    // re-enter dropping near the previous rate if it ended recently
+    m_dropping = true;
+    uint32_t delta = m_count - m_lastCount;
+    m_count = (delta > 1 && now - m_dropNext < 16 * m_interval) ? delta : 1;
+    m_lastCount = m_count;
+    m_dropNext = ControlLaw (now);
+    m_drops++;
+    return true;
+  }
+
+  uint64_t GetDrops () const { return m_drops; }
+
+private:
+  double ControlLaw (double t) const {
+    return t + m_interval / std::sqrt ((double)m_count);
+  }
+
+  double m_target, m_interval;
+  double m_firstAbove, m_dropNext;
+  uint32_t m_count, m_lastCount;
+  bool m_dropping;
+  uint64_t m_drops;
+};
+
+#endif /* CDOS_CODEL_H */
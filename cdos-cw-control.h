@@ -0,0 +1,66 @@
+/* Idle Sense contention-window control (Heusse et al., SIGCOMM 2005).
+ *
+ * Instead of doubling its window after every loss, each sender watches the
+ * channel: it averages the number of idle backoff slots between consecutive
+ * transmissions it senses and steers its window so that this average stays at
+ * a target that maximises throughput for the PHY. Too few idle slots means
+ * too many contenders or too small windows, so the window grows additively;
+ * too many idle slots shrink it multiplicatively. Collisions then no longer
+ * push the upstream senders of a hidden-terminal chain into ever longer
+ * backoffs and back again. The sender uses a single window (CWmin = CWmax).
+ */
+#ifndef CDOS_CW_CONTROL_H
+#define CDOS_CW_CONTROL_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+
+struct IdleSenseOptions {
+  double target;     // mean idle slots between transmissions, 3.91 for 802.11g
+  double epsilon;    // additive increase
+  double alpha;      // multiplicative decrease
+  unsigned maxTrans; // transmissions averaged per update
+  double cwLow, cwHigh;
+
+  IdleSenseOptions ()
+    : target (3.91), epsilon (6), alpha (1 / 1.0666), maxTrans (5), cwLow (1), cwHigh (1023) {}
+};
+
+class IdleSense {
+public:
+  IdleSense (const IdleSenseOptions &options, double cw)
+    : m_options (options), m_cw (cw), m_idle (0), m_transmissions (0), m_updates (0) {}
+
+  /* One idle period of the given number of backoff slots, ended by a
+   * transmission. Returns true when the window changed.
+   */
+  bool Observe (double slots){
+    m_idle += slots;
+    if (++m_transmissions < m_options.maxTrans){
+      return false;
+    }
+    double mean = m_idle / m_transmissions;
+    m_idle = 0;
+    m_transmissions = 0;
+    m_updates++;
+    double cw = mean < m_options.target ? m_cw + m_options.epsilon : m_cw * m_options.alpha;
+    cw = std::min (std::max (cw, m_options.cwLow), m_options.cwHigh);
+    bool changed = std::floor (cw + 0.5) != std::floor (m_cw + 0.5);
+    m_cw = cw;
+    return changed;
+  }
+
+  double GetCw () const { return m_cw; }
+  unsigned GetWindow () const { return (unsigned)std::floor (m_cw + 0.5); }
+  uint64_t GetUpdates () const { return m_updates; }
+
+private:
+  IdleSenseOptions m_options;
+  double m_cw;
+  double m_idle;
+  unsigned m_transmissions;
+  uint64_t m_updates;
+};
+
+#endif /* CDOS_CW_CONTROL_H */
@@ -0,0 +1,138 @@
+/* Random office deployments and the estimate of their cascade probability.
+ *
+ * A deployment puts each sender in a random room of the building and its
+ * receiver in the same or a nearby room on the same floor, both at desk height
+ * and away from the walls. As in the paper, the last pair is the attacker.
+ *
+ * Simulating every sample would be far too slow, so the topology analyser
+ * screens each layout first: it is flagged as risky when the attacker's flow
+ * hits a flow that in turn hits another one, the shape of the paper's chain.
+ * Only flagged layouts, and a small audit sample of the others to catch what
+ * the screen misses, are simulated. With pf the share of flagged layouts, pc
+ * the share of simulated flagged layouts that cascade and ps the same among the
+ * audited ones, the probability of a vulnerable deployment is
+ *
+ *   p = pf * pc + (1 - pf) * ps,
+ *
+ * bounded by the extremes of p over the Wilson intervals of the three shares.
+ */
+#ifndef CDOS_DEPLOYMENT_H
+#define CDOS_DEPLOYMENT_H
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+#include "cdos-floor-plan.h"
+#include "cdos-topology.h"
+
+struct DeploymentOptions {
+  unsigned pairs;
+  unsigned roomRange;  // rooms between a sender and its receiver, along each axis
+  double margin;       // m kept clear of the walls
+  double height;       // m above the floor
+
+  DeploymentOptions () : pairs (3), roomRange (1), margin (0.5), height (1) {}
+};
+
+class DeploymentSampler {
+public:
+  DeploymentSampler (const FloorPlan &plan, const DeploymentOptions &options)
+    : m_plan (plan), m_options (options) {
+    m_roomX = (plan.box[1] - plan.box[0]) / std::max (plan.roomsX, 1u);
+    m_roomY = (plan.box[3] - plan.box[2]) / std::max (plan.roomsY, 1u);
+    m_floorZ = (plan.box[5] - plan.box[4]) / std::max (plan.floors, 1u);
+  }
+
+  // Node positions, sender then receiver of every pair.
+  std::vector<Position> Sample (std::mt19937 &rng) const {
+    std::vector<Position> positions;
+    for (unsigned p = 0; p < m_options.pairs; ++p){
+      int x = Pick (rng, 0, (int)m_plan.roomsX - 1);
+      int y = Pick (rng, 0, (int)m_plan.roomsY - 1);
+      int z = Pick (rng, 0, (int)m_plan.floors - 1);
+      positions.push_back (InRoom (rng, x, y, z));
+      int r = m_options.roomRange;
+      int rx = Pick (rng, std::max (x - r, 0), std::min (x + r, (int)m_plan.roomsX - 1));
+      int ry = Pick (rng, std::max (y - r, 0), std::min (y + r, (int)m_plan.roomsY - 1));
+      positions.push_back (InRoom (rng, rx, ry, z));
+    }
+    return positions;
+  }
+
+private:
+  static int Pick (std::mt19937 &rng, int lo, int hi){
+    return std::uniform_int_distribution<int> (lo, std::max (lo, hi)) (rng);
+  }
+
+  Position InRoom (std::mt19937 &rng, int x, int y, int z) const {
+    double mx = std::min (m_options.margin, m_roomX / 4), my = std::min (m_options.margin, m_roomY / 4);
+    std::uniform_real_distribution<double> u (0, 1);
+    Position p;
+    p.x = m_plan.box[0] + x * m_roomX + mx + u (rng) * (m_roomX - 2 * mx);
+    p.y = m_plan.box[2] + y * m_roomY + my + u (rng) * (m_roomY - 2 * my);
+    p.z = m_plan.box[4] + z * m_floorZ + std::min (m_options.height, m_floorZ / 2);
+    return p;
+  }
+
+  FloorPlan m_plan;
+  DeploymentOptions m_options;
+  double m_roomX, m_roomY, m_floorZ;
+};
+
+// The attacker's flow hits a flow that hits a third one.
+inline bool StartsCascade (const TopologyAnalyser &analyser, size_t attacker){
+  const std::vector<size_t> &hit = analyser.HitsFrom (attacker);
+  for (size_t i = 0; i < hit.size (); ++i){
+    const std::vector<size_t> &next = analyser.HitsFrom (hit[i]);
+    for (size_t k = 0; k < next.size (); ++k){
+      if (next[k] != attacker){
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Wilson score interval of a proportion of k in n at z standard errors.
+inline std::pair<double, double> WilsonInterval (size_t k, size_t n, double z){
+  if (n == 0){
+    return std::make_pair (0.0, 1.0);
+  }
+  double p = (double)k / n, z2 = z * z;
+  double centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+  double half = z * std::sqrt (p * (1 - p) / n + z2 / (4.0 * n * n)) / (1 + z2 / n);
+  return std::make_pair (std::max (0.0, centre - half), std::min (1.0, centre + half));
+}
+
+struct CascadeEstimate {
+  double p, lower, upper;
+};
+
+// Probability of a vulnerable deployment from the screened, simulated and audited counts.
+inline CascadeEstimate EstimateCascadeProbability (size_t samples, size_t flagged, size_t simulated, size_t cascades,
+                                                   size_t audited, size_t missed, double z){
+  double pf = samples ? (double)flagged / samples : 0;
+  double pc = simulated ? (double)cascades / simulated : 0;
+  double ps = audited ? (double)missed / audited : 0;
+  std::pair<double, double> f = WilsonInterval (flagged, samples, z);
+  std::pair<double, double> c = simulated ? WilsonInterval (cascades, simulated, z) : std::make_pair (0.0, 1.0);
+  std::pair<double, double> s = audited ? WilsonInterval (missed, audited, z) : std::make_pair (0.0, 1.0);
+  CascadeEstimate e;
+  e.p = pf * pc + (1 - pf) * ps;
+  e.lower = 1;
+  e.upper = 0;
+  // p is linear in each share, so its extremes lie on the corners of the box
+  for (int corner = 0; corner < 8; ++corner){
+    double a = corner & 1 ? f.second : f.first;
+    double b = corner & 2 ? c.second : c.first;
+    double d = corner & 4 ? s.second : s.first;
+    double v = a * b + (1 - a) * d;
+    e.lower = std::min (e.lower, v);
+    e.upper = std::max (e.upper, v);
+  }
+  return e;
+}
+
+#endif /* CDOS_DEPLOYMENT_H */
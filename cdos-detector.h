@@ -0,0 +1,167 @@
+/* Local cascade-onset detector and its ROC evaluation.
+ *
+ * Every sender watches only what it can count itself: the share of its data
+ * transmissions that fail (retry rate), the fraction of time its PHY senses
+ * the medium busy or receives others' frames, and the growth of its own MAC
+ * queue. Per frame this is an increment; once per observation window the
+ * three values are turned into z-scores against a baseline learnt during a
+ * warm-up and then tracked by an exponentially weighted average, and a
+ * one-sided CUSUM of their combined score raises the alarm. The state is a handful of numbers per node, small
+ * enough for firmware.
+ *
+ * The harness labels each run with the cascade verdict of IsCascade and ranks
+ * runs by the peak CUSUM statistic of a detector, which gives the ROC curve;
+ * at the configured alarm level it also gives the detection latency after the
+ * attacker starts and the false alarms raised before it does.
+ */
+#ifndef CDOS_DETECTOR_H
+#define CDOS_DETECTOR_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+struct DetectorOptions {
+  double window;      // s per observation window
+  unsigned warmup;    // windows that only learn the baseline
+  double alpha;       // EWMA weight of a new window in the baseline
+  double drift;       // CUSUM allowance, in standard deviations
+  double threshold;   // CUSUM alarm level
+
+  DetectorOptions () : window (0.5), warmup (20), alpha (0.02), drift (0.5), threshold (8) {}
+};
+
+class CascadeDetector {
+public:
+  CascadeDetector (const DetectorOptions &options = DetectorOptions ())
+    : m_options (options), m_attempts (0), m_failures (0), m_busy (0), m_lastQueue (0),
+      m_windows (0), m_statistic (0), m_peak (0), m_alarm (-1) {
+    for (unsigned k = 0; k < FEATURES; ++k){
+      m_mean[k] = 0;
+      m_var[k] = 0;
+    }
+  }
+
+  // Per-frame observations, O(1) each.
+  void OnAttempt (){ m_attempts++; }
+  void OnFailure (){ m_failures++; }
+  void OnBusy (double seconds){ m_busy += seconds; }
+
+  /* Ends an observation window at time now with the MAC queue holding queue
+   * packets. Returns true when this window raised the first alarm.
+   */
+  bool CloseWindow (double now, uint32_t queue){
+    double x[FEATURES];
+    x[0] = m_attempts ? (double)m_failures / m_attempts : 0;
+    x[1] = std::min (m_busy / m_options.window, 1.0);
+    x[2] = ((double)queue - m_lastQueue) / m_options.window;
+    m_attempts = 0;
+    m_failures = 0;
+    m_busy = 0;
+    m_lastQueue = queue;
+
+    if (m_windows++ < m_options.warmup){
+      Learn (x, m_windows == 1 ? 1 : 1.0 / m_windows);
+      return false;
+    }
+    double score = 0;
+    for (unsigned k = 0; k < FEATURES; ++k){
+      score += (x[k] - m_mean[k]) / std::max (std::sqrt (m_var[k]), Floor (k));
+    }
+    score /= std::sqrt ((double)FEATURES);
+    m_statistic = std::max (0.0, m_statistic + score - m_options.drift);
+    m_peak = std::max (m_peak, m_statistic);
+    if (m_statistic < m_options.threshold){
+      // the baseline follows slow changes of the channel, but not an alarm
+      Learn (x, m_options.alpha);
+    }
+    if (m_alarm < 0 && m_statistic >= m_options.threshold){
+      m_alarm = now;
+      return true;
+    }
+    return false;
+  }
+
+  bool IsArmed () const { return m_windows > m_options.warmup; }
+  double GetStatistic () const { return m_statistic; }
+  double GetPeak () const { return m_peak; }
+  double GetAlarmTime () const { return m_alarm; }  // s, -1 before the first alarm
+
+  // Restarts the peak, to measure the peak of a later period separately.
+  void ResetPeak (){ m_peak = m_statistic; }
+
+private:
+  static const unsigned FEATURES = 3;
+
+  // Smallest standard deviation per feature, so a perfectly quiet baseline does not alarm on noise.
+  static double Floor (unsigned k){
+    return k == 2 ? 1.0 : 0.02;  // packets/s of queue growth, else shares
+  }
+
+  void Learn (const double *x, double weight){
+    for (unsigned k = 0; k < FEATURES; ++k){
+      double d = x[k] - m_mean[k];
+      m_mean[k] += weight * d;
+      m_var[k] = (1 - weight) * (m_var[k] + weight * d * d);
+    }
+  }
+
+  DetectorOptions m_options;
+  uint64_t m_attempts, m_failures;
+  double m_busy;
+  uint32_t m_lastQueue;
+  unsigned m_windows;
+  double m_mean[FEATURES], m_var[FEATURES];
+  double m_statistic, m_peak;
+  double m_alarm;
+};
+
+struct RocPoint {
+  double threshold;
+  double tpr, fpr;
+};
+
+/* ROC curve of a score against binary labels, one point per distinct score
+ * from the highest down, starting at (0, 0) and ending at (1, 1).
+ */
+inline std::vector<RocPoint> RocCurve (const std::vector<double> &score, const std::vector<bool> &label){
+  std::vector<std::pair<double, bool> > ranked;
+  size_t positives = 0;
+  for (size_t i = 0; i < score.size () && i < label.size (); ++i){
+    ranked.push_back (std::make_pair (score[i], label[i]));
+    positives += label[i];
+  }
+  size_t negatives = ranked.size () - positives;
+  std::sort (ranked.begin (), ranked.end (), [] (const std::pair<double, bool> &a, const std::pair<double, bool> &b){
+    return a.first > b.first;
+  });
+  std::vector<RocPoint> curve;
+  RocPoint p = {ranked.empty () ? 0 : ranked[0].first + 1, 0, 0};
+  curve.push_back (p);
+  size_t tp = 0, fp = 0;
+  for (size_t i = 0; i < ranked.size (); ++i){
+    tp += ranked[i].second;
+    fp += !ranked[i].second;
+    if (i + 1 < ranked.size () && ranked[i + 1].first == ranked[i].first){
+      continue;
+    }
+    p.threshold = ranked[i].first;
+    p.tpr = positives ? (double)tp / positives : 0;
+    p.fpr = negatives ? (double)fp / negatives : 0;
+    curve.push_back (p);
+  }
+  return curve;
+}
+
+// Area under a ROC curve by the trapezoidal rule.
+inline double RocArea (const std::vector<RocPoint> &curve){
+  double area = 0;
+  for (size_t i = 1; i < curve.size (); ++i){
+    area += (curve[i].fpr - curve[i - 1].fpr) * (curve[i].tpr + curve[i - 1].tpr) / 2;
+  }
+  return area;
+}
+
+#endif /* CDOS_DETECTOR_H */
@@ -0,0 +1,235 @@
+/* Determinism checks between a reference and an optimised execution path.
+ *
+ * A run with an event log records every MAC and PHY event of every node in
+ * the order the simulator executes them: time in ns, node, kind and packet
+ * size. The events are folded into a 64-bit FNV-1a hash as they happen and
+ * written to the log as fixed 20-byte records, so two logs are compared by
+ * streaming both to the first record that differs.
+ *
+ * Bit-exact equivalence means the same event hash and count and the same
+ * final counters. For an optimisation that intentionally changes the random
+ * draws, EquivalentMeans compares the two paths over many runs instead: their
+ * means must agree within z standard errors of the difference plus a relative
+ * tolerance.
+ */
+#ifndef CDOS_DETERMINISM_H
+#define CDOS_DETERMINISM_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cdos-experiment.h"
+
+enum TraceEventKind {
+  EVENT_PHY_TX_BEGIN,
+  EVENT_PHY_RX_BEGIN,
+  EVENT_PHY_RX_END,
+  EVENT_PHY_RX_DROP,
+  EVENT_MAC_TX,
+  EVENT_MAC_RX,
+  EVENT_MAC_TX_DROP,
+  EVENT_MAC_TX_FAILED,
+  EVENT_KINDS
+};
+
+inline const char *TraceEventName (uint32_t kind){
+  const char *names[EVENT_KINDS] = {"PhyTxBegin", "PhyRxBegin", "PhyRxEnd", "PhyRxDrop",
+                                    "MacTx", "MacRx", "MacTxDrop", "MacTxDataFailed"};
+  return kind < EVENT_KINDS ? names[kind] : "?";
+}
+
+struct TraceEvent {
+  int64_t time;   // ns
+  uint32_t node;
+  uint32_t kind;  // TraceEventKind
+  uint32_t size;  // bytes of the packet, 0 for events without one
+};
+
+inline std::string FormatTraceEvent (const TraceEvent &e){
+  std::ostringstream os;
+  os << "t=" << e.time << "ns node " << e.node << " " << TraceEventName (e.kind) << " " << e.size << " B";
+  return os.str ();
+}
+
+class EventTrace {
+public:
+  EventTrace () : m_hash (14695981039346656037ULL), m_count (0), m_file (NULL) {}
+
+  ~EventTrace (){
+    Close ();
+  }
+
+  // Also writes the events to path; without it only the hash is kept.
+  bool Open (const std::string &path){
+    Close ();
+    m_file = fopen (path.c_str (), "wb");
+    return m_file != NULL;
+  }
+
+  void Close (){
+    if (m_file != NULL){
+      fclose (m_file);
+      m_file = NULL;
+    }
+  }
+
+  void Record (const TraceEvent &e){
+    unsigned char bytes[RECORD];
+    Encode (e, bytes);
+    for (size_t i = 0; i < RECORD; ++i){
+      m_hash = (m_hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    m_count++;
+    if (m_file != NULL){
+      fwrite (bytes, 1, RECORD, m_file);
+    }
+  }
+
+  uint64_t GetHash () const { return m_hash; }
+  uint64_t GetCount () const { return m_count; }
+
+  // Next event of a log, false at its end.
+  static bool ReadEvent (FILE *file, TraceEvent &e){
+    unsigned char bytes[RECORD];
+    if (fread (bytes, 1, RECORD, file) != RECORD){
+      return false;
+    }
+    e.time = (int64_t)Get (bytes, 8);
+    e.node = (uint32_t)Get (bytes + 8, 4);
+    e.kind = (uint32_t)Get (bytes + 12, 4);
+    e.size = (uint32_t)Get (bytes + 16, 4);
+    return true;
+  }
+
+private:
+  EventTrace (const EventTrace &);
+  EventTrace &operator= (const EventTrace &);
+
+  static const size_t RECORD = 20;
+
+  // little endian whatever the host, so logs compare across machines
+  static void Put (unsigned char *p, uint64_t v, int bytes){
+    for (int i = 0; i < bytes; ++i){
+      p[i] = (unsigned char)(v >> (8 * i));
+    }
+  }
+
+  static uint64_t Get (const unsigned char *p, int bytes){
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i){
+      v = (v << 8) | p[i];
+    }
+    return v;
+  }
+
+  static void Encode (const TraceEvent &e, unsigned char *bytes){
+    Put (bytes, (uint64_t)e.time, 8);
+    Put (bytes + 8, e.node, 4);
+    Put (bytes + 12, e.kind, 4);
+    Put (bytes + 16, e.size, 4);
+  }
+
+  uint64_t m_hash;
+  uint64_t m_count;
+  FILE *m_file;
+};
+
+struct Divergence {
+  bool diverged;
+  uint64_t index;     // events that matched before the first difference
+  bool hasA, hasB;    // false where that log had already ended
+  TraceEvent a, b;
+};
+
+// First event at which two logs differ.
+inline Divergence FirstDivergence (const std::string &pathA, const std::string &pathB){
+  Divergence d;
+  d.diverged = false;
+  d.index = 0;
+  d.hasA = d.hasB = false;
+  FILE *fa = fopen (pathA.c_str (), "rb");
+  FILE *fb = fopen (pathB.c_str (), "rb");
+  if (fa != NULL && fb != NULL){
+    for (;; d.index++){
+      d.hasA = EventTrace::ReadEvent (fa, d.a);
+      d.hasB = EventTrace::ReadEvent (fb, d.b);
+      if (!d.hasA && !d.hasB){
+        break;
+      }
+      if (d.hasA != d.hasB || d.a.time != d.b.time || d.a.node != d.b.node || d.a.kind != d.b.kind || d.a.size != d.b.size){
+        d.diverged = true;
+        break;
+      }
+    }
+  }else{
+    d.diverged = fa != fb;
+  }
+  if (fa != NULL){
+    fclose (fa);
+  }
+  if (fb != NULL){
+    fclose (fb);
+  }
+  return d;
+}
+
+// Result fields that measure the host or say how the run was dispatched, not the simulation.
+inline bool IsHostField (const std::string &name){
+  return name == "wallTime" || name == "perfSetup" || name == "perfRun" || name == "perfTeardown" || name == "job";
+}
+
+/* Final counters that differ between two runs, as (name, "a | b"). The
+ * configuration fields are skipped, since the two paths may legitimately be
+ * configured differently.
+ */
+inline std::vector<std::pair<std::string, std::string> > DiffCounters (const ExperimentResult &a, const ExperimentResult &b){
+  std::vector<std::pair<std::string, std::string> > fa = ResultFields (a), fb = ResultFields (b);
+  std::vector<std::pair<std::string, std::string> > diff;
+  bool counters = false;
+  for (size_t i = 0; i < fa.size () && i < fb.size (); ++i){
+    // the outcome starts with throughput, everything before it is configuration
+    counters = counters || fa[i].first == "throughput";
+    if (counters && !IsHostField (fa[i].first) && fa[i].second != fb[i].second){
+      diff.push_back (std::make_pair (fa[i].first, fa[i].second + " | " + fb[i].second));
+    }
+  }
+  return diff;
+}
+
+struct MeanComparison {
+  double meanA, meanB;
+  double bound;       // largest difference accepted
+  bool equivalent;
+};
+
+/* Means of two samples agree when their difference is within z standard
+ * errors of it (Welch) plus relTolerance of the larger magnitude.
+ */
+inline MeanComparison EquivalentMeans (const std::vector<double> &a, const std::vector<double> &b, double z, double relTolerance){
+  double va = 0, vb = 0;
+  MeanComparison c;
+  c.meanA = c.meanB = 0;
+  for (size_t i = 0; i < a.size (); ++i){
+    c.meanA += a[i] / a.size ();
+  }
+  for (size_t i = 0; i < b.size (); ++i){
+    c.meanB += b[i] / b.size ();
+  }
+  for (size_t i = 0; i < a.size (); ++i){
+    va += (a[i] - c.meanA) * (a[i] - c.meanA) / std::max<size_t> (a.size () - 1, 1);
+  }
+  for (size_t i = 0; i < b.size (); ++i){
+    vb += (b[i] - c.meanB) * (b[i] - c.meanB) / std::max<size_t> (b.size () - 1, 1);
+  }
+  double se = std::sqrt ((a.empty () ? 0 : va / a.size ()) + (b.empty () ? 0 : vb / b.size ()));
+  c.bound = z * se + relTolerance * std::max (std::fabs (c.meanA), std::fabs (c.meanB));
+  c.equivalent = std::fabs (c.meanA - c.meanB) <= c.bound;
+  return c;
+}
+
+#endif /* CDOS_DETERMINISM_H */
@@ -0,0 +1,83 @@
+/* EDCA parameters of the best-effort access category per sender role.
+ *
+ * The spec is a ';'-separated list of role:aifsn:cwMin:cwMax:txopLimit
+ * entries, the TXOP limit in microseconds. Empty fields keep the value of
+ * earlier entries or the ns-3 default, so "all:2;facing::::1088" gives every
+ * sender AIFSN 2 and the attacker-facing sender a 1088 us TXOP. Roles:
+ *
+ *   attacker  the sender of the last pair (node NumofNode-2)
+ *   facing    the sender next to the attacker (node NumofNode-4), whose
+ *             losses to the attacker start the cascade
+ *   rest      every other sender
+ *   all       every sender
+ */
+#ifndef CDOS_EDCA_H
+#define CDOS_EDCA_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cdos-airtime.h"
+
+struct EdcaParams {
+  int aifsn, cwMin, cwMax;  // -1 keeps the ns-3 default
+  double txopLimit;         // us, -1 keeps the ns-3 default
+
+  EdcaParams () : aifsn (-1), cwMin (-1), cwMax (-1), txopLimit (-1) {}
+};
+
+inline std::string EdcaRole (size_t sender, size_t numofNode){
+  if (sender + 2 == numofNode){
+    return "attacker";
+  }
+  if (sender + 4 == numofNode){
+    return "facing";
+  }
+  return "rest";
+}
+
+// Parameters of the given sender node after applying every matching entry.
+inline EdcaParams ParseEdca (const std::string &spec, size_t sender, size_t numofNode){
+  EdcaParams p;
+  std::string role = EdcaRole (sender, numofNode);
+  std::stringstream ss (spec);
+  std::string entry;
+  while (std::getline (ss, entry, ';')){
+    std::vector<std::string> f;
+    std::stringstream es (entry);
+    std::string item;
+    while (std::getline (es, item, ':')){
+      f.push_back (item);
+    }
+    if (f.empty () || (f[0] != "all" && f[0] != role)){
+      continue;
+    }
+    f.resize (5);
+    if (!f[1].empty ()) p.aifsn = std::atoi (f[1].c_str ());
+    if (!f[2].empty ()) p.cwMin = std::atoi (f[2].c_str ());
+    if (!f[3].empty ()) p.cwMax = std::atoi (f[3].c_str ());
+    if (!f[4].empty ()) p.txopLimit = std::atof (f[4].c_str ());
+  }
+  return p;
+}
+
+/* Largest IP packet whose whole frame exchange fits a TXOP limit of limitUs,
+ * 0 for no limit. ns-3.22 has no TxopLimit and sends one MSDU (with all its
+ * fragments) per channel access, so the limit is enforced by giving the
+ * sender this MTU: IPv4 then splits every datagram into MSDUs that each take
+ * one access of at most the limit. Frame timing as in cdos-airtime.h.
+ */
+inline uint32_t TxopMtu (double limitUs, bool rtsCts){
+  if (limitUs <= 0){
+    return 0;
+  }
+  const double handshake = rtsCts ? DsssLongUs (RTS_BYTES) + DsssLongUs (CTS_BYTES) + 2 * SIFS_US : 0;
+  double mpdu = ErpOfdmBytes (limitUs - handshake - SIFS_US - ErpOfdmUs (ACK_BYTES));
+  // MAC header, FCS and LLC/SNAP around the IP packet; IPv4 needs at least 68 bytes
+  return (uint32_t)std::max (mpdu - 24 - 4 - 8, 68.0);
+}
+
+#endif /* CDOS_EDCA_H */
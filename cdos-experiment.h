@@ -0,0 +1,432 @@
+/* Plain-data description of a single experiment() run and of its outcome.
+ *
+ * The sweep modes of CDoS-6Mbps-adhoc-UDP-building.cc pass these structures
+ * between forked workers and persist them in a CSV result store. Nothing in
+ * here depends on ns-3, so the analysis code can load a result store without
+ * running the simulator.
+ */
+#ifndef CDOS_EXPERIMENT_H
+#define CDOS_EXPERIMENT_H
+
+#include <stdint.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+
+// Scenario parameters. The defaults are the configuration of the paper.
+struct ExperimentConfig {
+  bool enableCtsRts;
+  uint16_t numofNode;
+  uint16_t durationofSimulation;  // s
+  double firstNodeLoad;           // load of the attacking sender, node NumofNode-2
+  double restNodeLoad;            // load of every other sender
+  uint16_t pktLength;             // UDP payload, bytes
+  double attackStart;             // s, the attacking sender turns on
+  double attackStop;              // s, the attacking sender turns off
+  double wallLoss;                // dB, InternalWallLoss of the building model
+  double nodeSpacing;             // m between neighbouring nodes
+  uint32_t maxSlrc;               // long retry limit
+  uint32_t fragThreshold;         // bytes, MAC fragmentation threshold
+  bool qos;                       // QoS MAC with EDCA instead of the DCF of AdhocWifiMac
+  std::string edca;               // per-role EDCA parameters (cdos-edca.h), with qos only
+  std::string cwControl;          // contention-window control of the senders: dcf or idle-sense
+  double idleTarget;              // idle-sense target of idle slots per transmission
+  std::string layout;             // node positions "x:y:z;x:y:z;...", empty for the chain of the paper
+  std::string floorPlan;          // floor-plan file (cdos-floor-plan.h), empty for the building of the paper
+  std::string txPower;            // dBm per node "p0;p1;...", nodes past the end keep the PHY default
+  std::string ccaThreshold;       // dBm per node, carrier-sense threshold, same format
+  std::string channels;           // channel index per pair "c0;c1;...", pairs past the end use channel 0
+  double shaperShare;             // airtime share allowed to every sender, 0 for no shaper
+  bool shaperAuto;                // self-tune the share from the sensed neighbour activity
+  double shaperGain;              // self-tuned share: gain times the airtime not sensed busy
+  uint32_t macQueueSize;          // packets, WifiMacQueue limit
+  double macQueueDelay;           // s, WifiMacQueue packet lifetime
+  std::string aqm;                // queue management above the MAC queue: none or codel
+  double codelTarget;             // s
+  double codelInterval;           // s
+  std::string attackPattern;      // attacker traffic: poisson (FirstNodeLoad) or burst
+  double burstPeriod;             // s between the starts of two bursts
+  double burstDuty;               // share of the period the attacker sends at 6 Mbps
+  uint16_t attackPktLength;       // bytes of the attacker's packets in bursts, 0 for PktLength
+  uint32_t seed;
+  uint32_t run;
+  // Run-time options below are not part of the scenario and are not stored.
+  bool enableAthstats;
+  std::string progressSocket;     // Unix socket for live progress, empty for none
+  double progressInterval;        // simulated s between progress reports
+  double maxWallTime;             // watchdog limits, 0 for none: wall-clock s,
+  uint64_t maxEvents;             // PHY events
+  double maxRssMb;                // and peak resident memory
+  bool measureDelay;              // track the one-way delay of every packet
+  bool detect;                    // run the cascade-onset detector (cdos-detector.h) at every sender
+  double detectorWindow;          // s per detector observation window
+  double detectorDrift;           // CUSUM allowance, in standard deviations
+  double detectorThreshold;       // CUSUM alarm level
+  bool perfCounters;              // count cycles, instructions and misses per phase (cdos-perf-counters.h)
+  std::string scheduler;          // ns-3 event scheduler type, empty for the default ns3::MapScheduler
+  bool traceEvents;               // hash the ordered MAC/PHY events (cdos-determinism.h)
+  std::string eventLog;           // and write them to this file, empty for none
+
+  ExperimentConfig ()
+    : enableCtsRts (false), numofNode (6), durationofSimulation (203),
+      firstNodeLoad (1), restNodeLoad (0.14), pktLength (1500),
+      attackStart (53), attackStop (153), wallLoss (12), nodeSpacing (8),
+      maxSlrc (7), fragThreshold (2300), qos (false), cwControl ("dcf"), idleTarget (3.91),
+      shaperShare (0), shaperAuto (false), shaperGain (0.5),
+      macQueueSize (400), macQueueDelay (10), aqm ("none"), codelTarget (0.005), codelInterval (0.1),
+      attackPattern ("poisson"), burstPeriod (0.1), burstDuty (0.5), attackPktLength (0), seed (1), run (1),
+      enableAthstats (true), progressInterval (1),
+      maxWallTime (0), maxEvents (0), maxRssMb (0), measureDelay (false),
+      detect (false), detectorWindow (0.5), detectorDrift (0.5), detectorThreshold (8), perfCounters (false), traceEvents (false) {}
+};
+
+struct Position {
+  double x, y, z;
+};
+
+// Parses a layout string; entries that do not hold three numbers are skipped.
+inline std::vector<Position> ParseLayout (const std::string &layout){
+  std::vector<Position> positions;
+  std::stringstream ss (layout);
+  std::string item;
+  while (std::getline (ss, item, ';')){
+    Position p;
+    char c1, c2;
+    std::stringstream is (item);
+    if (is >> p.x >> c1 >> p.y >> c2 >> p.z){
+      positions.push_back (p);
+    }
+  }
+  return positions;
+}
+
+inline std::string FormatLayout (const std::vector<Position> &positions){
+  std::ostringstream os;
+  os << std::setprecision (6);
+  for (size_t i = 0; i < positions.size (); ++i){
+    os << (i ? ";" : "") << positions[i].x << ":" << positions[i].y << ":" << positions[i].z;
+  }
+  return os.str ();
+}
+
+// Outcome of one run. Pair i is the flow from node 2i to node 2i+1; the last
+// pair is the attacker and pair 0, the farthest from it, is the victim.
+struct ExperimentResult {
+  ExperimentConfig config;
+  std::vector<double> throughput;  // Mbps delivered during the attack window
+  std::vector<double> offered;     // Mbps offered by the sender
+  double wallTime;                 // s of wall-clock time for setup, run and teardown
+  uint64_t phyEvents;              // PHY transmissions and receptions started
+  std::string truncated;           // watchdog limit that stopped the run, "none" if complete
+  std::vector<double> txFailure;   // share of failed data transmissions per sender
+  std::vector<double> contentionWindow;  // final window per sender under cwControl, else empty
+  std::vector<double> delay;       // s, mean one-way delay per pair in the attack window, with measureDelay
+  double attackAirtime;            // share of the attack window the attacker's PHY transmits
+  std::vector<double> alarm;       // s, first detector alarm per sender, -1 for none, with detect
+  std::vector<double> detectorPeak;     // peak CUSUM statistic per sender from the attack start on
+  std::vector<double> detectorPrePeak;  // and before it
+  double simulatedTime;            // s actually simulated
+  std::vector<double> perfSetup;     // cycles, instructions, cache and branch misses of the setup, -1 if unavailable,
+  std::vector<double> perfRun;       // of Simulator::Run
+  std::vector<double> perfTeardown;  // and of the teardown, with perfCounters
+  uint64_t packets;                // packets the applications sent, with perfCounters
+  uint64_t eventHash;              // FNV-1a hash of the ordered MAC/PHY events, with traceEvents
+  uint64_t events;                 // and their number
+  std::string job;                 // id of the queue job that produced the run, empty outside the queue
+
+  ExperimentResult () : wallTime (0), phyEvents (0), truncated ("none"), attackAirtime (0), simulatedTime (0), packets (0),
+                       eventHash (0), events (0) {}
+
+  bool IsTruncated () const { return truncated != "none"; }
+};
+
+// Delivered over offered load of one pair; 1 for a pair that offers nothing.
+inline double NormalizedThroughput (const ExperimentResult &r, size_t pair){
+  if (pair >= r.throughput.size () || pair >= r.offered.size () || r.offered[pair] <= 0){
+    return 1;
+  }
+  return r.throughput[pair] / r.offered[pair];
+}
+
+// A verdict needs a complete run: a failed run has no throughput, and one the
+// watchdog stopped measured only the part of the attack window it reached.
+inline bool HasVerdict (const ExperimentResult &r){
+  return r.throughput.size () >= 2 && !r.IsTruncated ();
+}
+
+// The cascade has happened when the victim pair, which only offers the light
+// RestNodeLoad, can no longer deliver it during the attack.
+inline bool IsCascade (const ExperimentResult &r, double tolerance){
+  if (r.throughput.size () < 2){
+    return false;
+  }
+  return NormalizedThroughput (r, 0) < 1 - tolerance;
+}
+
+inline double TotalThroughput (const ExperimentResult &r){
+  double total = 0;
+  for (size_t i = 0; i < r.throughput.size (); ++i){
+    total += r.throughput[i];
+  }
+  return total;
+}
+
+/* CSV serialisation. Columns are matched by name when loading, so adding a
+ * field only needs an entry in ResultFields and in SetResultField, and old
+ * stores stay readable.
+ */
+inline std::string JoinValues (const std::vector<double> &v){
+  std::ostringstream os;
+  os << std::setprecision (10);
+  for (size_t i = 0; i < v.size (); ++i){
+    os << (i ? ";" : "") << v[i];
+  }
+  return os.str ();
+}
+
+inline std::vector<double> SplitValues (const std::string &s){
+  std::vector<double> v;
+  std::stringstream ss (s);
+  std::string item;
+  while (std::getline (ss, item, ';')){
+    if (!item.empty ()){
+      v.push_back (std::atof (item.c_str ()));
+    }
+  }
+  return v;
+}
+
+inline std::vector<std::pair<std::string, std::string> > ResultFields (const ExperimentResult &r){
+  std::vector<std::pair<std::string, std::string> > f;
+  const ExperimentConfig &c = r.config;
+  std::ostringstream os;
+  os << std::setprecision (10);
+#define CDOS_FIELD(name, value) os.str (""); os << value; f.push_back (std::make_pair (std::string (name), os.str ()))
+  CDOS_FIELD ("rts", c.enableCtsRts);
+  CDOS_FIELD ("nodes", c.numofNode);
+  CDOS_FIELD ("duration", c.durationofSimulation);
+  CDOS_FIELD ("u0", c.firstNodeLoad);
+  CDOS_FIELD ("rho", c.restNodeLoad);
+  CDOS_FIELD ("T", c.pktLength);
+  CDOS_FIELD ("attackStart", c.attackStart);
+  CDOS_FIELD ("attackStop", c.attackStop);
+  CDOS_FIELD ("wallLoss", c.wallLoss);
+  CDOS_FIELD ("spacing", c.nodeSpacing);
+  CDOS_FIELD ("maxSlrc", c.maxSlrc);
+  CDOS_FIELD ("fragThreshold", c.fragThreshold);
+  CDOS_FIELD ("qos", c.qos);
+  CDOS_FIELD ("edca", c.edca);
+  CDOS_FIELD ("cwControl", c.cwControl);
+  CDOS_FIELD ("idleTarget", c.idleTarget);
+  CDOS_FIELD ("layout", c.layout);
+  CDOS_FIELD ("floorPlan", c.floorPlan);
+  CDOS_FIELD ("txPower", c.txPower);
+  CDOS_FIELD ("ccaThreshold", c.ccaThreshold);
+  CDOS_FIELD ("channels", c.channels);
+  CDOS_FIELD ("shaperShare", c.shaperShare);
+  CDOS_FIELD ("shaperAuto", c.shaperAuto);
+  CDOS_FIELD ("shaperGain", c.shaperGain);
+  CDOS_FIELD ("macQueueSize", c.macQueueSize);
+  CDOS_FIELD ("macQueueDelay", c.macQueueDelay);
+  CDOS_FIELD ("aqm", c.aqm);
+  CDOS_FIELD ("codelTarget", c.codelTarget);
+  CDOS_FIELD ("codelInterval", c.codelInterval);
+  CDOS_FIELD ("attackPattern", c.attackPattern);
+  CDOS_FIELD ("burstPeriod", c.burstPeriod);
+  CDOS_FIELD ("burstDuty", c.burstDuty);
+  CDOS_FIELD ("attackPktLength", c.attackPktLength);
+  CDOS_FIELD ("seed", c.seed);
+  CDOS_FIELD ("run", c.run);
+  CDOS_FIELD ("throughput", JoinValues (r.throughput));
+  CDOS_FIELD ("offered", JoinValues (r.offered));
+  CDOS_FIELD ("wallTime", r.wallTime);
+  CDOS_FIELD ("phyEvents", r.phyEvents);
+  CDOS_FIELD ("truncated", r.truncated);
+  CDOS_FIELD ("txFailure", JoinValues (r.txFailure));
+  CDOS_FIELD ("contentionWindow", JoinValues (r.contentionWindow));
+  CDOS_FIELD ("delay", JoinValues (r.delay));
+  CDOS_FIELD ("attackAirtime", r.attackAirtime);
+  CDOS_FIELD ("alarm", JoinValues (r.alarm));
+  CDOS_FIELD ("detectorPeak", JoinValues (r.detectorPeak));
+  CDOS_FIELD ("detectorPrePeak", JoinValues (r.detectorPrePeak));
+  CDOS_FIELD ("simulatedTime", r.simulatedTime);
+  CDOS_FIELD ("perfSetup", JoinValues (r.perfSetup));
+  CDOS_FIELD ("perfRun", JoinValues (r.perfRun));
+  CDOS_FIELD ("perfTeardown", JoinValues (r.perfTeardown));
+  CDOS_FIELD ("packets", r.packets);
+  CDOS_FIELD ("eventHash", r.eventHash);
+  CDOS_FIELD ("events", r.events);
+  CDOS_FIELD ("job", r.job);
+#undef CDOS_FIELD
+  return f;
+}
+
+inline void SetResultField (ExperimentResult &r, const std::string &name, const std::string &value){
+  ExperimentConfig &c = r.config;
+  double v = std::atof (value.c_str ());
+  if (name == "rts") c.enableCtsRts = (v != 0);
+  else if (name == "nodes") c.numofNode = (uint16_t)v;
+  else if (name == "duration") c.durationofSimulation = (uint16_t)v;
+  else if (name == "u0") c.firstNodeLoad = v;
+  else if (name == "rho") c.restNodeLoad = v;
+  else if (name == "T") c.pktLength = (uint16_t)v;
+  else if (name == "attackStart") c.attackStart = v;
+  else if (name == "attackStop") c.attackStop = v;
+  else if (name == "wallLoss") c.wallLoss = v;
+  else if (name == "spacing") c.nodeSpacing = v;
+  else if (name == "maxSlrc") c.maxSlrc = (uint32_t)v;
+  else if (name == "fragThreshold") c.fragThreshold = (uint32_t)v;
+  else if (name == "qos") c.qos = v != 0;
+  else if (name == "edca") c.edca = value;
+  else if (name == "cwControl") c.cwControl = value;
+  else if (name == "idleTarget") c.idleTarget = v;
+  else if (name == "layout") c.layout = value;
+  else if (name == "floorPlan") c.floorPlan = value;
+  else if (name == "txPower") c.txPower = value;
+  else if (name == "ccaThreshold") c.ccaThreshold = value;
+  else if (name == "channels") c.channels = value;
+  else if (name == "shaperShare") c.shaperShare = v;
+  else if (name == "shaperAuto") c.shaperAuto = v != 0;
+  else if (name == "shaperGain") c.shaperGain = v;
+  else if (name == "macQueueSize") c.macQueueSize = (uint32_t)v;
+  else if (name == "macQueueDelay") c.macQueueDelay = v;
+  else if (name == "aqm") c.aqm = value;
+  else if (name == "codelTarget") c.codelTarget = v;
+  else if (name == "codelInterval") c.codelInterval = v;
+  else if (name == "attackPattern") c.attackPattern = value;
+  else if (name == "burstPeriod") c.burstPeriod = v;
+  else if (name == "burstDuty") c.burstDuty = v;
+  else if (name == "attackPktLength") c.attackPktLength = (uint16_t)v;
+  else if (name == "seed") c.seed = (uint32_t)v;
+  else if (name == "run") c.run = (uint32_t)v;
+  else if (name == "throughput") r.throughput = SplitValues (value);
+  else if (name == "offered") r.offered = SplitValues (value);
+  else if (name == "wallTime") r.wallTime = v;
+  else if (name == "phyEvents") r.phyEvents = std::strtoull (value.c_str (), NULL, 10);
+  else if (name == "truncated") r.truncated = value;
+  else if (name == "txFailure") r.txFailure = SplitValues (value);
+  else if (name == "contentionWindow") r.contentionWindow = SplitValues (value);
+  else if (name == "delay") r.delay = SplitValues (value);
+  else if (name == "attackAirtime") r.attackAirtime = v;
+  else if (name == "alarm") r.alarm = SplitValues (value);
+  else if (name == "detectorPeak") r.detectorPeak = SplitValues (value);
+  else if (name == "detectorPrePeak") r.detectorPrePeak = SplitValues (value);
+  else if (name == "simulatedTime") r.simulatedTime = v;
+  else if (name == "perfSetup") r.perfSetup = SplitValues (value);
+  else if (name == "perfRun") r.perfRun = SplitValues (value);
+  else if (name == "perfTeardown") r.perfTeardown = SplitValues (value);
+  else if (name == "packets") r.packets = std::strtoull (value.c_str (), NULL, 10);
+  else if (name == "eventHash") r.eventHash = std::strtoull (value.c_str (), NULL, 10);
+  else if (name == "events") r.events = std::strtoull (value.c_str (), NULL, 10);
+  else if (name == "job") r.job = value;
+}
+
+inline std::string ResultHeader (){
+  std::vector<std::pair<std::string, std::string> > f = ResultFields (ExperimentResult ());
+  std::string line;
+  for (size_t i = 0; i < f.size (); ++i){
+    line += (i ? "," : "") + f[i].first;
+  }
+  return line;
+}
+
+inline std::string FormatResult (const ExperimentResult &r){
+  std::vector<std::pair<std::string, std::string> > f = ResultFields (r);
+  std::string line;
+  for (size_t i = 0; i < f.size (); ++i){
+    line += (i ? "," : "") + f[i].second;
+  }
+  return line;
+}
+
+inline std::vector<std::string> SplitCsv (const std::string &line){
+  std::vector<std::string> cols;
+  std::stringstream ss (line);
+  std::string col;
+  while (std::getline (ss, col, ',')){
+    cols.push_back (col);
+  }
+  return cols;
+}
+
+// Parses a line written by FormatResult under the given header.
+inline bool ParseResult (const std::string &header, const std::string &line, ExperimentResult &r){
+  std::vector<std::string> names = SplitCsv (header);
+  std::vector<std::string> values = SplitCsv (line);
+  if (values.empty ()){
+    return false;
+  }
+  r = ExperimentResult ();
+  for (size_t i = 0; i < names.size () && i < values.size (); ++i){
+    SetResultField (r, names[i], values[i]);
+  }
+  return !r.throughput.empty ();
+}
+
+/* Parses the configuration of a line written by FormatResult, such as a job
+ * without an outcome yet. False unless every configuration column, those
+ * before throughput, is present.
+ */
+inline bool ParseConfig (const std::string &header, const std::string &line, ExperimentConfig &config){
+  std::vector<std::string> names = SplitCsv (header);
+  std::vector<std::string> values = SplitCsv (line);
+  size_t columns = std::find (names.begin (), names.end (), "throughput") - names.begin ();
+  if (columns == 0 || columns == names.size () || values.size () < columns){
+    return false;
+  }
+  ExperimentResult r;
+  ParseResult (header, line, r);
+  config = r.config;
+  return true;
+}
+
+inline std::vector<ExperimentResult> LoadResults (const std::string &path);
+
+/* Appends results to a CSV store, writing the header when the file is new. A
+ * store written with an older set of columns is rewritten with the current
+ * header first.
+ */
+inline void AppendResults (const std::string &path, const std::vector<ExperimentResult> &results){
+  std::ifstream probe (path.c_str ());
+  std::string header;
+  bool exists = std::getline (probe, header) && !header.empty ();
+  probe.close ();
+  std::vector<ExperimentResult> rows;
+  std::ios::openmode mode = std::ios::app;
+  if (exists && header != ResultHeader ()){
+    rows = LoadResults (path);
+    mode = std::ios::trunc;
+    exists = false;
+  }
+  rows.insert (rows.end (), results.begin (), results.end ());
+  std::ofstream out (path.c_str (), std::ios::out | mode);
+  if (!exists){
+    out << ResultHeader () << "\n";
+  }
+  for (size_t i = 0; i < rows.size (); ++i){
+    out << FormatResult (rows[i]) << "\n";
+  }
+}
+
+inline std::vector<ExperimentResult> LoadResults (const std::string &path){
+  std::vector<ExperimentResult> results;
+  std::ifstream in (path.c_str ());
+  std::string header, line;
+  if (!std::getline (in, header)){
+    return results;
+  }
+  while (std::getline (in, line)){
+    ExperimentResult r;
+    if (ParseResult (header, line, r)){
+      results.push_back (r);
+    }
+  }
+  return results;
+}
+
+#endif /* CDOS_EXPERIMENT_H */
@@ -0,0 +1,167 @@
+/* Site description read from a floor-plan file.
+ *
+ * One statement per line, '#' starts a comment, lengths in metres:
+ *
+ *   building <xmin> <xmax> <ymin> <ymax> <zmin> <zmax>
+ *   rooms <nx> <ny> <floors>       grid of rooms of the building model
+ *   wallloss <dB>                  loss of every internal wall of the grid
+ *   wall <x1> <y1> <x2> <y2> <dB>  extra wall, added to every link crossing it
+ *   txpower <dBm>                  survey transmit power, to turn RSSI into loss
+ *   node <x> <y> <z>               node positions, in node order
+ *   rssi <tx> <rx> <dBm>           measured received power
+ *   loss <tx> <rx> <dB>            measured path loss
+ *
+ * A measurement of one direction is used for the other direction too unless
+ * that one was measured as well. The model losses of all other pairs are
+ * overridden by the measured ones before they go into a loss table, so the
+ * channel does a table lookup per frame instead of the building model.
+ */
+#ifndef CDOS_FLOOR_PLAN_H
+#define CDOS_FLOOR_PLAN_H
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cdos-experiment.h"
+#include "cdos-topology.h"
+
+struct Wall {
+  double x1, y1, x2, y2;
+  double loss;
+};
+
+struct FloorPlan {
+  double box[6];
+  uint32_t roomsX, roomsY, floors;
+  double wallLoss;
+  double txPower;
+  std::vector<Wall> walls;
+  std::vector<Position> nodes;
+  std::map<std::pair<size_t, size_t>, double> measured;  // (tx, rx) -> loss (dB)
+
+  // The building of the paper
+  FloorPlan ()
+    : roomsX (11), roomsY (1), floors (1), wallLoss (12), txPower (16.0206){
+    double b[6] = {0, 44, -3, 3, 0, 3};
+    for (int i = 0; i < 6; ++i){
+      box[i] = b[i];
+    }
+  }
+
+  bool Contains (const Position &p) const {
+    return p.x >= box[0] && p.x <= box[1] && p.y >= box[2] && p.y <= box[3] && p.z >= box[4] && p.z <= box[5];
+  }
+
+  // Adds rooms of the same width at the low-x end until x is inside.
+  void ExtendTo (double x){
+    double room = (box[1] - box[0]) / std::max (roomsX, 1u);
+    while (x < box[0]){
+      box[0] -= room;
+      roomsX++;
+    }
+  }
+
+  // Sum of the extra walls crossed by the straight path between a and b.
+  double ExtraWallLoss (const Position &a, const Position &b) const {
+    double loss = 0;
+    for (size_t i = 0; i < walls.size (); ++i){
+      const Wall &w = walls[i];
+      double d1 = Cross (w.x1, w.y1, w.x2, w.y2, a.x, a.y);
+      double d2 = Cross (w.x1, w.y1, w.x2, w.y2, b.x, b.y);
+      double d3 = Cross (a.x, a.y, b.x, b.y, w.x1, w.y1);
+      double d4 = Cross (a.x, a.y, b.x, b.y, w.x2, w.y2);
+      if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))){
+        loss += w.loss;
+      }
+    }
+    return loss;
+  }
+
+  // Replaces the model losses of the measured pairs.
+  void ApplyMeasurements (LossMatrix &loss) const {
+    std::map<std::pair<size_t, size_t>, double>::const_iterator it;
+    for (it = measured.begin (); it != measured.end (); ++it){
+      size_t tx = it->first.first, rx = it->first.second;
+      if (tx >= loss.size () || rx >= loss.size ()){
+        continue;
+      }
+      loss[tx][rx] = it->second;
+      if (measured.find (std::make_pair (rx, tx)) == measured.end ()){
+        loss[rx][tx] = it->second;
+      }
+    }
+  }
+
+private:
+  static double Cross (double ax, double ay, double bx, double by, double px, double py){
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+  }
+};
+
+// Reads a floor plan; on failure error names the offending line.
+inline bool LoadFloorPlan (const std::string &path, FloorPlan &plan, std::string &error){
+  std::ifstream in (path.c_str ());
+  if (!in){
+    error = "cannot open " + path;
+    return false;
+  }
+  std::vector<std::pair<std::pair<size_t, size_t>, double> > rssi;
+  std::string line;
+  for (int n = 1; std::getline (in, line); ++n){
+    size_t hash = line.find ('#');
+    if (hash != std::string::npos){
+      line.erase (hash);
+    }
+    std::istringstream is (line);
+    std::string key;
+    if (!(is >> key)){
+      continue;
+    }
+    bool ok;
+    if (key == "building"){
+      ok = bool (is >> plan.box[0] >> plan.box[1] >> plan.box[2] >> plan.box[3] >> plan.box[4] >> plan.box[5]);
+    }else if (key == "rooms"){
+      ok = bool (is >> plan.roomsX >> plan.roomsY >> plan.floors);
+    }else if (key == "wallloss"){
+      ok = bool (is >> plan.wallLoss);
+    }else if (key == "txpower"){
+      ok = bool (is >> plan.txPower);
+    }else if (key == "wall"){
+      Wall w;
+      ok = bool (is >> w.x1 >> w.y1 >> w.x2 >> w.y2 >> w.loss);
+      plan.walls.push_back (w);
+    }else if (key == "node"){
+      Position p;
+      ok = bool (is >> p.x >> p.y >> p.z);
+      plan.nodes.push_back (p);
+    }else if (key == "rssi" || key == "loss"){
+      size_t tx, rx;
+      double v;
+      ok = bool (is >> tx >> rx >> v);
+      if (key == "loss"){
+        plan.measured[std::make_pair (tx, rx)] = v;
+      }else {
+        rssi.push_back (std::make_pair (std::make_pair (tx, rx), v));
+      }
+    }else {
+      ok = false;
+    }
+    if (!ok){
+      std::ostringstream os;
+      os << path << ":" << n << ": cannot parse '" << line << "'";
+      error = os.str ();
+      return false;
+    }
+  }
+  // RSSI is converted once the survey power is known, wherever it was given
+  for (size_t i = 0; i < rssi.size (); ++i){
+    plan.measured[rssi[i].first] = plan.txPower - rssi[i].second;
+  }
+  return true;
+}
+
+#endif /* CDOS_FLOOR_PLAN_H */
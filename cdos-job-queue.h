@@ -0,0 +1,330 @@
+/* Coordinator-free job queue in a shared directory (e.g. an NFS mount).
+ *
+ *   pending/<id>[~<n>].job           waiting jobs, n earlier attempts failed
+ *   claimed/<id>[~<n>].job@<host>.<pid>  jobs being run; the mtime is the lease
+ *   done/<id>.result                 finished runs not merged yet
+ *   merged/<id>.result               runs already in the result store
+ *   failed/<id>~<n>.job              jobs given up after n failed attempts
+ *
+ * All state changes are rename()s, which are atomic on a single file system,
+ * so any number of worker processes on any host can share the directory. A
+ * worker claims a job by renaming it out of pending/, and refreshes the mtime
+ * of its claim while it runs. A claim older than the lease is renamed back
+ * to pending/ by whichever worker notices it first, so jobs are run at least
+ * once. A run that crashed, or a claim that had to be recovered, counts as a
+ * failed attempt; after the attempt limit the job goes to failed/. Lease ages are measured against a file touched on the share, so the
+ * hosts' clocks need not agree. Results are merged into the store by one
+ * worker at a time under a mkdir() lock. The lock holds an owner file whose
+ * mtime the merging worker refreshes as it goes, and which it checks still
+ * names it before it writes the store.
+ */
+#ifndef CDOS_JOB_QUEUE_H
+#define CDOS_JOB_QUEUE_H
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utime.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cdos-experiment.h"
+
+class JobQueue {
+public:
+  JobQueue (const std::string &dir, double lease, unsigned attempts = 3)
+    : m_dir (dir), m_lease (lease), m_attempts (attempts){
+    char host[256] = "host";
+    gethostname (host, sizeof (host) - 1);
+    std::ostringstream os;
+    os << host << "." << getpid ();
+    m_owner = os.str ();
+    mkdir (m_dir.c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+    mkdir (Path ("pending").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+    mkdir (Path ("claimed").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+    mkdir (Path ("done").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+    mkdir (Path ("merged").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+    mkdir (Path ("failed").c_str (), S_IRWXU | S_IRWXG | S_IRWXO);
+  }
+
+  // Removes this worker's clock probe (ShareTime) from the queue root.
+  ~JobQueue (){
+    unlink (Path (".clock." + m_owner).c_str ());
+  }
+
+  /* Adds jobs. The id orders the claims, so jobs submitted in LPT order are
+   * also claimed in that order. Each job file holds a store header and one
+   * configuration line.
+   */
+  void Submit (const std::string &id, const ExperimentConfig &config){
+    ExperimentResult r;
+    r.config = config;
+    std::string tmp = Path ("pending/." + id + "." + m_owner);
+    std::ofstream out (tmp.c_str ());
+    out << ResultHeader () << "\n" << FormatResult (r) << "\n";
+    out.close ();
+    rename (tmp.c_str (), Path ("pending/" + id + ".job").c_str ());
+  }
+
+  /* Claims the first pending job; false when none is left. A job file that
+   * is cut short or cannot be parsed goes straight to failed/.
+   */
+  bool Claim (std::string &id, ExperimentConfig &config){
+    std::vector<std::string> jobs = List ("pending", ".job");
+    for (size_t i = 0; i < jobs.size (); ++i){
+      std::string claim = Path ("claimed/" + jobs[i] + "@" + m_owner);
+      if (rename (Path ("pending/" + jobs[i]).c_str (), claim.c_str ()) != 0){
+        continue;  // another worker was faster
+      }
+      std::ifstream in (claim.c_str ());
+      std::string header, line;
+      // the line must end in a newline, or the file was cut inside it
+      bool ok = std::getline (in, header) && std::getline (in, line) && !in.eof () && ParseConfig (header, line, config);
+      in.close ();
+      if (!ok){
+        rename (claim.c_str (), Path ("failed/" + jobs[i]).c_str ());
+        m_corrupt.push_back (jobs[i]);
+        continue;
+      }
+      id = JobId (jobs[i]);
+      m_claims[id] = jobs[i];
+      Heartbeat (id);
+      return true;
+    }
+    return false;
+  }
+
+  // Job files this worker found unreadable and moved to failed/.
+  const std::vector<std::string> &GetCorrupt () const { return m_corrupt; }
+
+  // Renews the lease; false if the claim was lost to a recovery.
+  bool Heartbeat (const std::string &id){
+    return utime (ClaimPath (id).c_str (), NULL) == 0;
+  }
+
+  // Publishes the result of a claim; false, and nothing written, if the claim was lost.
+  bool Complete (const std::string &id, const ExperimentResult &result){
+    if (!Heartbeat (id)){
+      m_claims.erase (id);
+      return false;
+    }
+    ExperimentResult r = result;
+    r.job = id;
+    std::string tmp = Path ("done/." + id + "." + m_owner);
+    std::ofstream out (tmp.c_str ());
+    out << ResultHeader () << "\n" << FormatResult (r) << "\n";
+    out.close ();
+    rename (tmp.c_str (), Path ("done/" + id + ".result").c_str ());
+    unlink (ClaimPath (id).c_str ());
+    m_claims.erase (id);
+    return true;
+  }
+
+  /* Releases a claim whose run failed: back to pending/ for another attempt,
+   * or to failed/ once the attempts are used up. True when the job was given up.
+   */
+  bool Fail (const std::string &id){
+    bool failed = Release (ClaimPath (id), m_claims[id]);
+    m_claims.erase (id);
+    return failed;
+  }
+
+  // Puts the claims whose lease ran out back into pending/.
+  size_t RecoverStale (){
+    double now = ShareTime ();
+    size_t recovered = 0;
+    std::vector<std::string> claims = List ("claimed", "");
+    for (size_t i = 0; i < claims.size (); ++i){
+      struct stat st;
+      std::string path = Path ("claimed/" + claims[i]);
+      if (stat (path.c_str (), &st) != 0 || now - st.st_mtime <= m_lease){
+        continue;
+      }
+      // the worker died or hung, which counts against the job as well
+      Release (path, claims[i].substr (0, claims[i].find ('@')));
+      recovered++;
+    }
+    return recovered;
+  }
+
+  /* Appends the finished runs to the result store. Only one worker merges at
+   * a time; a lock not refreshed for longer than the lease is assumed to
+   * belong to a dead worker. A worker that finds its lock broken stops
+   * without touching the store. Every row carries its job id, and a job
+   * already in the store is not appended again: a job run twice after a
+   * recovery, or a merge that died between the append and the renames.
+   */
+  size_t Merge (const std::string &store){
+    std::string lock = Path ("merge.lock");
+    if (mkdir (lock.c_str (), S_IRWXU) != 0){
+      BreakStaleLock ();
+      return 0;
+    }
+    std::ofstream (Path ("merge.lock/owner").c_str ()) << m_owner << "\n";
+    std::vector<std::string> done = List ("done", ".result");
+    std::set<std::string> merged;
+    if (!done.empty ()){
+      std::vector<ExperimentResult> stored = LoadResults (store);
+      for (size_t i = 0; i < stored.size (); ++i){
+        merged.insert (stored[i].job);
+      }
+    }
+    std::vector<ExperimentResult> results;
+    for (size_t i = 0; i < done.size (); ++i){
+      if (i % 64 == 0 && !RefreshLock ()){
+        return 0;
+      }
+      std::ifstream in (Path ("done/" + done[i]).c_str ());
+      std::string header, line;
+      ExperimentResult r;
+      if (std::getline (in, header) && std::getline (in, line) && ParseResult (header, line, r)){
+        r.job = done[i].substr (0, done[i].size () - 7);
+        if (merged.insert (r.job).second){
+          results.push_back (r);
+        }
+      }
+    }
+    if (!RefreshLock ()){
+      return 0;
+    }
+    AppendResults (store, results);
+    for (size_t i = 0; i < done.size (); ++i){
+      if (i % 64 == 0){
+        RefreshLock ();
+      }
+      rename (Path ("done/" + done[i]).c_str (), Path ("merged/" + done[i]).c_str ());
+    }
+    if (RefreshLock ()){
+      unlink (Path ("merge.lock/owner").c_str ());
+      rmdir (lock.c_str ());
+    }
+    return results.size ();
+  }
+
+  size_t Pending () { return List ("pending", ".job").size (); }
+  size_t Claimed () { return List ("claimed", "").size (); }
+  size_t Unmerged () { return List ("done", ".result").size (); }
+  size_t Done () { return Unmerged () + List ("merged", ".result").size (); }
+  size_t Failed () { return List ("failed", ".job").size (); }
+  const std::string &GetOwner () const { return m_owner; }
+
+private:
+  std::string Path (const std::string &name) const {
+    return m_dir + "/" + name;
+  }
+
+  std::string ClaimPath (const std::string &id) const {
+    std::map<std::string, std::string>::const_iterator it = m_claims.find (id);
+    return Path ("claimed/" + (it != m_claims.end () ? it->second : id + ".job") + "@" + m_owner);
+  }
+
+  // Job id of a job file name "<id>[~<attempts>].job".
+  static std::string JobId (const std::string &name){
+    std::string id = name.substr (0, name.size () - 4);
+    return id.substr (0, id.find ('~'));
+  }
+
+  static unsigned FailedAttempts (const std::string &name){
+    size_t tilde = name.find ('~');
+    return tilde == std::string::npos ? 0 : (unsigned)std::atoi (name.c_str () + tilde + 1);
+  }
+
+  // Moves a claim with one more failed attempt to pending/, or to failed/ at the limit.
+  bool Release (const std::string &claim, const std::string &job){
+    unsigned attempts = FailedAttempts (job) + 1;
+    std::ostringstream name;
+    name << JobId (job) << "~" << attempts << ".job";
+    bool failed = attempts >= m_attempts;
+    rename (claim.c_str (), Path ((failed ? "failed/" : "pending/") + name.str ()).c_str ());
+    return failed;
+  }
+
+  // Sorted names in a sub-directory with the given suffix, skipping temporaries.
+  std::vector<std::string> List (const std::string &sub, const std::string &suffix) const {
+    std::vector<std::string> names;
+    DIR *d = opendir (Path (sub).c_str ());
+    if (d == NULL){
+      return names;
+    }
+    struct dirent *e;
+    while ((e = readdir (d)) != NULL){
+      std::string name = e->d_name;
+      if (name.empty () || name[0] == '.'){
+        continue;
+      }
+      if (name.size () >= suffix.size () && name.compare (name.size () - suffix.size (), suffix.size (), suffix) == 0){
+        names.push_back (name);
+      }
+    }
+    closedir (d);
+    std::sort (names.begin (), names.end ());
+    return names;
+  }
+
+  // Renews the merge lock; false if it is no longer ours.
+  bool RefreshLock () const {
+    std::string path = Path ("merge.lock/owner");
+    std::ifstream in (path.c_str ());
+    std::string owner;
+    return std::getline (in, owner) && owner == m_owner && utime (path.c_str (), NULL) == 0;
+  }
+
+  /* Removes a merge lock not refreshed within the lease. The lock is renamed
+   * aside first, so of several workers noticing it only one removes it, and
+   * it is checked again there in case it was taken anew in between.
+   */
+  void BreakStaleLock () const {
+    std::string lock = Path ("merge.lock");
+    std::string stale = Path (".merge.lock." + m_owner);
+    if (!IsStaleLock (lock) || rename (lock.c_str (), stale.c_str ()) != 0){
+      return;
+    }
+    if (!IsStaleLock (stale)){
+      rename (stale.c_str (), lock.c_str ());
+      return;
+    }
+    unlink ((stale + "/owner").c_str ());
+    rmdir (stale.c_str ());
+  }
+
+  // A lock without an owner file yet is judged by the directory, made just before it.
+  bool IsStaleLock (const std::string &lock) const {
+    struct stat st;
+    if (stat ((lock + "/owner").c_str (), &st) != 0 && stat (lock.c_str (), &st) != 0){
+      return false;
+    }
+    return ShareTime () - st.st_mtime > m_lease;
+  }
+
+  // Current time according to the file server.
+  double ShareTime () const {
+    std::string probe = Path (".clock." + m_owner);
+    int fd = open (probe.c_str (), O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR);
+    if (fd >= 0){
+      close (fd);
+    }
+    utime (probe.c_str (), NULL);
+    struct stat st;
+    if (stat (probe.c_str (), &st) != 0){
+      return time (NULL);
+    }
+    return st.st_mtime;
+  }
+
+  std::string m_dir;
+  double m_lease;
+  unsigned m_attempts;
+  std::string m_owner;
+  std::map<std::string, std::string> m_claims;  // id -> job file name of this worker's claims
+  std::vector<std::string> m_corrupt;
+};
+
+#endif /* CDOS_JOB_QUEUE_H */
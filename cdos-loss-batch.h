@@ -0,0 +1,217 @@
+/* Batch evaluation of the indoor building path loss for all node pairs.
+ *
+ * For two nodes in the same building HybridBuildingsPropagationLossModel of
+ * ns-3.22 returns the ITU-R P.1238 loss plus the internal wall loss for the
+ * Manhattan distance in rooms between them:
+ *
+ *   L = 20 log10(f / MHz) + N log10(d) + Lf(floors) - 28 + wallLoss (|dx| + |dy|)
+ *
+ * Calling the model pair by pair costs a virtual call, the building lookups
+ * of both nodes and a log10 each, which dominates the screening of large
+ * layouts. Here positions, rooms and floors are precomputed once in
+ * structure-of-arrays form and a whole row (one transmitter, every receiver)
+ * is evaluated in one loop: with AVX2, four receivers at a time with a vector
+ * logarithm, else with the scalar loop. Rows are shared out over threads.
+ *
+ * Only nodes inside the building are covered; entries involving a node outside
+ * it are NaN and left to the model. The shadowing of the model is random and
+ * not part of these losses.
+ */
+#ifndef CDOS_LOSS_BATCH_H
+#define CDOS_LOSS_BATCH_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "cdos-experiment.h"
+#include "cdos-topology.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CDOS_LOSS_BATCH_AVX2 1
+#endif
+
+// Office building of the model: ITU-R P.1238 N = 30 and Lf = 15 + 4 (n - 1) dB for n floors between.
+struct BuildingGeometry {
+  double box[6];           // xmin xmax ymin ymax zmin zmax, m
+  uint32_t roomsX, roomsY, floors;
+  double wallLoss;         // dB per internal wall
+  double frequency;        // Hz
+  double distanceExponent; // N
+  double floorLoss;        // dB through the first floor
+  double extraFloorLoss;   // dB through every further floor
+
+  BuildingGeometry ()
+    : roomsX (1), roomsY (1), floors (1), wallLoss (5), frequency (2.4e9),
+      distanceExponent (30), floorLoss (15), extraFloorLoss (4){
+    for (int i = 0; i < 6; ++i){
+      box[i] = 0;
+    }
+  }
+};
+
+class LossBatch {
+public:
+  LossBatch (const BuildingGeometry &geometry, const std::vector<Position> &positions)
+    : m_geometry (geometry){
+    size_t n = positions.size ();
+    m_x.resize (n);
+    m_y.resize (n);
+    m_z.resize (n);
+    m_roomX.resize (n);
+    m_roomY.resize (n);
+    m_floor.resize (n);
+    m_indoor.resize (n);
+    const double *b = geometry.box;
+    for (size_t i = 0; i < n; ++i){
+      const Position &p = positions[i];
+      m_x[i] = p.x;
+      m_y[i] = p.y;
+      m_z[i] = p.z;
+      m_indoor[i] = p.x >= b[0] && p.x <= b[1] && p.y >= b[2] && p.y <= b[3] && p.z >= b[4] && p.z <= b[5];
+      m_roomX[i] = Cell (p.x, b[0], b[1], geometry.roomsX);
+      m_roomY[i] = Cell (p.y, b[2], b[3], geometry.roomsY);
+      m_floor[i] = Cell (p.z, b[4], b[5], geometry.floors);
+    }
+    m_constant = 20 * std::log10 (geometry.frequency / 1e6) - 28;
+  }
+
+  size_t GetNodes () const { return m_x.size (); }
+
+  static bool HasSimd (){
+#ifdef CDOS_LOSS_BATCH_AVX2
+    return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+#else
+    return false;
+#endif
+  }
+
+  // Loss (dB) from tx to every node into loss[0..n), 0 to itself, NaN where a node is outside.
+  void Row (size_t tx, double *loss, bool simd) const {
+    size_t n = GetNodes ();
+    size_t done = 0;
+#ifdef CDOS_LOSS_BATCH_AVX2
+    if (simd && HasSimd ()){
+      done = RowAvx2 (tx, loss);
+    }
+#endif
+    RowScalar (tx, loss, done, n);
+    for (size_t j = 0; j < n; ++j){
+      if (!m_indoor[tx] || !m_indoor[j]){
+        loss[j] = std::numeric_limits<double>::quiet_NaN ();
+      }
+    }
+    loss[tx] = 0;
+  }
+
+  LossMatrix Matrix (unsigned threads, bool simd) const {
+    size_t n = GetNodes ();
+    LossMatrix loss (n, std::vector<double> (n, 0));
+    threads = std::max (1u, std::min<unsigned> (threads, (unsigned)std::max<size_t> (n / 64, 1)));
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t){
+      // interleaved rows keep the share of every thread even
+      pool.push_back (std::thread ([this, &loss, t, threads, n, simd] (){
+        for (size_t i = t; i < n; i += threads){
+          Row (i, &loss[i][0], simd);
+        }
+      }));
+    }
+    for (size_t t = 0; t < pool.size (); ++t){
+      pool[t].join ();
+    }
+    return loss;
+  }
+
+private:
+  // 1-based room or floor index along one axis, as Building::GetRoomX and GetFloor.
+  static double Cell (double v, double lo, double hi, uint32_t cells){
+    if (v == hi || hi <= lo){
+      return cells;
+    }
+    return std::floor (cells * (v - lo) / (hi - lo)) + 1;
+  }
+
+  double FloorLoss (double floors) const {
+    return floors >= 1 ? m_geometry.floorLoss + m_geometry.extraFloorLoss * (floors - 1) : 0;
+  }
+
+  void RowScalar (size_t tx, double *loss, size_t from, size_t to) const {
+    double n2 = m_geometry.distanceExponent / 2;
+    for (size_t j = from; j < to; ++j){
+      double dx = m_x[j] - m_x[tx], dy = m_y[j] - m_y[tx], dz = m_z[j] - m_z[tx];
+      double walls = std::fabs (m_roomX[j] - m_roomX[tx]) + std::fabs (m_roomY[j] - m_roomY[tx]);
+      double l = m_constant + n2 * std::log10 (dx * dx + dy * dy + dz * dz)
+        + FloorLoss (std::fabs (m_floor[j] - m_floor[tx])) + m_geometry.wallLoss * walls;
+      loss[j] = std::max (l, 0.0);
+    }
+  }
+
+#ifdef CDOS_LOSS_BATCH_AVX2
+  /* Natural logarithm of four positive doubles: x = 2^e m with m in
+   * [sqrt(1/2), sqrt(2)), and log(m) = 2 atanh((m - 1) / (m + 1)) by its
+   * series, accurate to about 1e-14.
+   */
+  __attribute__ ((target ("avx2,fma")))
+  static __m256d Log4 (__m256d x){
+    const __m256i bits = _mm256_castpd_si256 (x);
+    // exponent as a double: the biased exponent bits placed into the mantissa of 2^52
+    __m256i biased = _mm256_srli_epi64 (bits, 52);
+    __m256d e = _mm256_sub_pd (_mm256_castsi256_pd (_mm256_or_si256 (biased, _mm256_set1_epi64x (0x4330000000000000LL))),
+                               _mm256_set1_pd (4503599627370496.0 + 1023));
+    __m256d m = _mm256_castsi256_pd (_mm256_or_si256 (_mm256_and_si256 (bits, _mm256_set1_epi64x (0x000fffffffffffffLL)),
+                                                      _mm256_set1_epi64x (0x3ff0000000000000LL)));
+    __m256d big = _mm256_cmp_pd (m, _mm256_set1_pd (1.4142135623730951), _CMP_GT_OQ);
+    m = _mm256_blendv_pd (m, _mm256_mul_pd (m, _mm256_set1_pd (0.5)), big);
+    e = _mm256_add_pd (e, _mm256_and_pd (big, _mm256_set1_pd (1)));
+    __m256d f = _mm256_div_pd (_mm256_sub_pd (m, _mm256_set1_pd (1)), _mm256_add_pd (m, _mm256_set1_pd (1)));
+    __m256d f2 = _mm256_mul_pd (f, f);
+    __m256d s = _mm256_set1_pd (1.0 / 17);
+    const double c[8] = {1.0 / 15, 1.0 / 13, 1.0 / 11, 1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3, 1};
+    for (int k = 0; k < 8; ++k){
+      s = _mm256_fmadd_pd (s, f2, _mm256_set1_pd (c[k]));
+    }
+    __m256d logm = _mm256_mul_pd (_mm256_mul_pd (s, f), _mm256_set1_pd (2));
+    return _mm256_fmadd_pd (e, _mm256_set1_pd (0.6931471805599453), logm);
+  }
+
+  // Whole blocks of four receivers; returns the number of receivers done.
+  __attribute__ ((target ("avx2,fma")))
+  size_t RowAvx2 (size_t tx, double *loss) const {
+    size_t n = GetNodes ();
+    const __m256d x0 = _mm256_set1_pd (m_x[tx]), y0 = _mm256_set1_pd (m_y[tx]), z0 = _mm256_set1_pd (m_z[tx]);
+    const __m256d rx0 = _mm256_set1_pd (m_roomX[tx]), ry0 = _mm256_set1_pd (m_roomY[tx]), f0 = _mm256_set1_pd (m_floor[tx]);
+    const __m256d sign = _mm256_set1_pd (-0.0), zero = _mm256_setzero_pd (), one = _mm256_set1_pd (1);
+    // N log10(d) = N / (2 ln 10) ln(d^2)
+    const __m256d slope = _mm256_set1_pd (m_geometry.distanceExponent / (2 * 2.302585092994046));
+    const __m256d constant = _mm256_set1_pd (m_constant), wall = _mm256_set1_pd (m_geometry.wallLoss);
+    const __m256d floorLoss = _mm256_set1_pd (m_geometry.floorLoss - m_geometry.extraFloorLoss);
+    const __m256d extraFloor = _mm256_set1_pd (m_geometry.extraFloorLoss);
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4){
+      __m256d dx = _mm256_sub_pd (_mm256_loadu_pd (&m_x[j]), x0);
+      __m256d dy = _mm256_sub_pd (_mm256_loadu_pd (&m_y[j]), y0);
+      __m256d dz = _mm256_sub_pd (_mm256_loadu_pd (&m_z[j]), z0);
+      __m256d d2 = _mm256_fmadd_pd (dz, dz, _mm256_fmadd_pd (dy, dy, _mm256_mul_pd (dx, dx)));
+      __m256d walls = _mm256_add_pd (_mm256_andnot_pd (sign, _mm256_sub_pd (_mm256_loadu_pd (&m_roomX[j]), rx0)),
+                                     _mm256_andnot_pd (sign, _mm256_sub_pd (_mm256_loadu_pd (&m_roomY[j]), ry0)));
+      __m256d floors = _mm256_andnot_pd (sign, _mm256_sub_pd (_mm256_loadu_pd (&m_floor[j]), f0));
+      __m256d lf = _mm256_and_pd (_mm256_cmp_pd (floors, one, _CMP_GE_OQ), _mm256_fmadd_pd (extraFloor, floors, floorLoss));
+      __m256d l = _mm256_fmadd_pd (slope, Log4 (d2), _mm256_fmadd_pd (wall, walls, _mm256_add_pd (constant, lf)));
+      _mm256_storeu_pd (&loss[j], _mm256_max_pd (l, zero));
+    }
+    return j;
+  }
+#endif
+
+  BuildingGeometry m_geometry;
+  double m_constant;  // dB, frequency term of P.1238
+  std::vector<double> m_x, m_y, m_z;
+  std::vector<double> m_roomX, m_roomY, m_floor;
+  std::vector<char> m_indoor;
+};
+
+#endif /* CDOS_LOSS_BATCH_H */
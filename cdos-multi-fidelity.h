@@ -0,0 +1,59 @@
+/* Multi-fidelity screening for the sweep modes.
+ *
+ * Every point first gets a short run: a few seconds for the light senders to
+ * settle, then a short attack window. Only the points whose screening verdict
+ * is not clear-cut are promoted to full-length runs, optionally replicated
+ * with independent RNG runs. The screening runs go to a store of their own,
+ * so that the cost model, the surrogate and the other consumers of the main
+ * store only ever see full-length runs.
+ */
+#ifndef CDOS_MULTI_FIDELITY_H
+#define CDOS_MULTI_FIDELITY_H
+
+#include <cmath>
+#include <string>
+#include "cdos-experiment.h"
+
+struct FidelityOptions {
+  double screenStart;     // s, attacker turns on in a screening run
+  double screenWindow;    // s, steady-state attack window measured
+  double margin;          // distance to the verdict threshold always promoted
+  double z;               // confidence of the counting-noise band
+  unsigned replications;  // full runs per promoted point
+  std::string store;      // result store of the screening runs, apart from the full-length ones
+
+  FidelityOptions ()
+    : screenStart (13), screenWindow (20), margin (0.05), z (2), replications (1), store ("screening.csv") {}
+};
+
+// Short version of a full-length configuration.
+inline ExperimentConfig ScreeningConfig (const ExperimentConfig &full, const FidelityOptions &opt){
+  ExperimentConfig c = full;
+  c.attackStart = opt.screenStart;
+  c.attackStop = opt.screenStart + opt.screenWindow;
+  c.durationofSimulation = (uint16_t)std::ceil (c.attackStop);
+  c.enableAthstats = false;
+  return c;
+}
+
+/* A screening verdict is trusted when the victim throughput lies farther from
+ * the threshold than the margin plus z standard errors. The standard error
+ * treats the delivered packets of the victim as a Poisson count.
+ */
+inline bool IsAmbiguous (const ExperimentResult &screen, double tolerance, const FidelityOptions &opt){
+  if (!HasVerdict (screen)){
+    return true;
+  }
+  double window = screen.config.attackStop - screen.config.attackStart;
+  double packets = screen.offered[0] * 1e6 * window / (8.0 * screen.config.pktLength);
+  double v = NormalizedThroughput (screen, 0);
+  double se = packets > 0 ? std::sqrt ((v > 0 ? v : 1.0 / packets) / packets) : 0;
+  return std::fabs (v - (1 - tolerance)) < opt.margin + opt.z * se;
+}
+
+// Simulated seconds of a configuration, the CPU cost proxy of the report.
+inline double SimulatedCost (const ExperimentConfig &c){
+  return c.durationofSimulation;
+}
+
+#endif /* CDOS_MULTI_FIDELITY_H */
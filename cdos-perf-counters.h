@@ -0,0 +1,114 @@
+/* Hardware performance counters of the running process.
+ *
+ * Cycles, retired instructions, last-level cache misses and branch misses of
+ * user-space code are counted with perf_event_open from construction on; a
+ * phase is measured as the difference of two readings. Each counter is opened
+ * on its own, so one the CPU or the kernel does not offer leaves the others
+ * working. A counter that cannot be opened (no permission under
+ * perf_event_paranoid, a virtual machine without a PMU, a kernel other than
+ * Linux) reads -1. When the kernel multiplexes the counters, the counts are
+ * scaled by the share of the time they were actually counting.
+ */
+#ifndef CDOS_PERF_COUNTERS_H
+#define CDOS_PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+enum PerfCounter {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_CACHE_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_COUNTERS
+};
+
+inline const char *PerfCounterName (int k){
+  const char *names[PERF_COUNTERS] = {"cycles", "instructions", "cacheMisses", "branchMisses"};
+  return names[k];
+}
+
+class PerfCounters {
+public:
+  // Opens nothing unless enabled, so a disabled instance costs nothing.
+  explicit PerfCounters (bool enabled = true){
+    for (int k = 0; k < PERF_COUNTERS; ++k){
+      m_fd[k] = enabled ? Open (k) : -1;
+    }
+  }
+
+  ~PerfCounters (){
+    for (int k = 0; k < PERF_COUNTERS; ++k){
+      if (m_fd[k] >= 0){
+        close (m_fd[k]);
+      }
+    }
+  }
+
+  bool IsAvailable () const {
+    for (int k = 0; k < PERF_COUNTERS; ++k){
+      if (m_fd[k] >= 0){
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Counts since construction, one per PerfCounter, -1 where unavailable.
+  std::vector<double> Read () const {
+    std::vector<double> v (PERF_COUNTERS, -1);
+    for (int k = 0; k < PERF_COUNTERS; ++k){
+      uint64_t data[3];  // value, time enabled, time running
+      if (m_fd[k] < 0 || read (m_fd[k], data, sizeof (data)) != (ssize_t)sizeof (data) || data[2] == 0){
+        continue;
+      }
+      v[k] = data[2] < data[1] ? (double)data[0] * data[1] / data[2] : (double)data[0];
+    }
+    return v;
+  }
+
+private:
+  PerfCounters (const PerfCounters &);
+  PerfCounters &operator= (const PerfCounters &);
+
+  static int Open (int k){
+#ifdef __linux__
+    const uint64_t configs[PERF_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    struct perf_event_attr attr;
+    memset (&attr, 0, sizeof (attr));
+    attr.size = sizeof (attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[k];
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // user space only, which perf_event_paranoid 2 still allows
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall (__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+#else
+    return -1;
+#endif
+  }
+
+  int m_fd[PERF_COUNTERS];
+};
+
+// Counts between two readings, -1 where either is unavailable.
+inline std::vector<double> PerfDelta (const std::vector<double> &from, const std::vector<double> &to){
+  std::vector<double> d (PERF_COUNTERS, -1);
+  for (size_t k = 0; k < d.size () && k < from.size () && k < to.size (); ++k){
+    if (from[k] >= 0 && to[k] >= 0){
+      d[k] = to[k] - from[k];
+    }
+  }
+  return d;
+}
+
+#endif /* CDOS_PERF_COUNTERS_H */
@@ -0,0 +1,301 @@
+/* Adaptive phase diagram of the cascade over (RestNodeLoad, PktLength).
+ *
+ * The map starts from a coarse grid of cells and only subdivides the cells
+ * whose corners disagree on the cascade verdict, or whose victim throughput
+ * changes by more than a gradient threshold, until the resolution floor is
+ * reached. Each refinement level is handed to the evaluator as one batch so
+ * the points of a level can be simulated in parallel. A point whose run has
+ * no verdict is evaluated again, up to a retry limit, and stays unknown after
+ * that: it neither splits a cell nor places the boundary.
+ */
+#ifndef CDOS_PHASE_MAP_H
+#define CDOS_PHASE_MAP_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+#include <utility>
+#include <functional>
+
+struct PhaseSample {
+  double rho;
+  uint16_t pktLength;
+  bool known;     // false for a run without a verdict, which takes no part in the map
+  bool cascade;
+  double victim;  // normalised throughput of the victim pair
+};
+
+struct PhaseMapOptions {
+  double rhoMin, rhoMax;
+  uint16_t pktMin, pktMax;
+  unsigned coarseRho, coarsePkt;  // cells of the initial grid
+  double minRhoStep;              // resolution floor
+  unsigned minPktStep;
+  double maxGradient;             // largest victim throughput change tolerated in a cell
+  double level;                   // victim throughput at which the verdict flips
+  unsigned retries;               // evaluations again of a point without a verdict
+
+  PhaseMapOptions ()
+    : rhoMin (0.02), rhoMax (0.30), pktMin (200), pktMax (1500),
+      coarseRho (4), coarsePkt (4), minRhoStep (0.01), minPktStep (50),
+      maxGradient (0.25), level (0.9), retries (2) {}
+};
+
+typedef std::pair<double, uint16_t> PhasePoint;
+// Evaluates a batch of points; attempt counts the earlier evaluations of the batch's points.
+typedef std::function<std::vector<PhaseSample> (const std::vector<PhasePoint> &, unsigned attempt)> PhaseEvaluator;
+typedef std::vector<std::pair<double, double> > Polyline;
+
+class PhaseMap {
+public:
+  PhaseMap (const PhaseMapOptions &opt, const PhaseEvaluator &eval)
+    : m_opt (opt), m_eval (eval), m_runs (0) {}
+
+  // Refines the map down to the resolution floor. Returns the number of levels.
+  unsigned Refine (){
+    std::vector<Cell> active;
+    for (unsigned i = 0; i < m_opt.coarseRho; ++i){
+      for (unsigned j = 0; j < m_opt.coarsePkt; ++j){
+        Cell c;
+        c.r0 = m_opt.rhoMin + (m_opt.rhoMax - m_opt.rhoMin) * i / m_opt.coarseRho;
+        c.r1 = m_opt.rhoMin + (m_opt.rhoMax - m_opt.rhoMin) * (i + 1) / m_opt.coarseRho;
+        c.t0 = (uint16_t)(m_opt.pktMin + (m_opt.pktMax - m_opt.pktMin) * j / m_opt.coarsePkt);
+        c.t1 = (uint16_t)(m_opt.pktMin + (m_opt.pktMax - m_opt.pktMin) * (j + 1) / m_opt.coarsePkt);
+        active.push_back (c);
+      }
+    }
+    EvaluateCorners (active);
+    unsigned levels = 1;
+    m_leaves.clear ();
+    while (!active.empty ()){
+      std::vector<Cell> next;
+      for (size_t k = 0; k < active.size (); ++k){
+        const Cell &c = active[k];
+        bool splitRho = (c.r1 - c.r0) / 2 >= m_opt.minRhoStep - 1e-12;
+        bool splitPkt = (c.t1 - c.t0) / 2 >= (int)m_opt.minPktStep;
+        if (!NeedsSplit (c) || (!splitRho && !splitPkt)){
+          m_leaves.push_back (c);
+          continue;
+        }
+        double rm = (c.r0 + c.r1) / 2;
+        uint16_t tm = (uint16_t)((c.t0 + c.t1) / 2);
+        double rs[3] = {c.r0, splitRho ? rm : c.r1, c.r1};
+        uint16_t ts[3] = {c.t0, splitPkt ? tm : c.t1, c.t1};
+        for (int a = 0; a < (splitRho ? 2 : 1); ++a){
+          for (int b = 0; b < (splitPkt ? 2 : 1); ++b){
+            Cell child;
+            child.r0 = rs[a];
+            child.r1 = rs[a + 1];
+            child.t0 = ts[b];
+            child.t1 = ts[b + 1];
+            next.push_back (child);
+          }
+        }
+      }
+      if (!next.empty ()){
+        EvaluateCorners (next);
+        ++levels;
+      }
+      active.swap (next);
+    }
+    return levels;
+  }
+
+  std::vector<PhaseSample> GetSamples () const {
+    std::vector<PhaseSample> samples;
+    for (std::map<Key, PhaseSample>::const_iterator it = m_samples.begin (); it != m_samples.end (); ++it){
+      samples.push_back (it->second);
+    }
+    return samples;
+  }
+
+  unsigned GetRuns () const { return m_runs; }
+
+  // Points still without a verdict after the retries.
+  unsigned GetUnknown () const {
+    unsigned n = 0;
+    for (std::map<Key, PhaseSample>::const_iterator it = m_samples.begin (); it != m_samples.end (); ++it){
+      n += !it->second.known;
+    }
+    return n;
+  }
+
+  // Runs a uniform grid at the resolution floor would have needed.
+  unsigned GetUniformRuns () const {
+    unsigned nr = (unsigned)std::ceil ((m_opt.rhoMax - m_opt.rhoMin) / m_opt.minRhoStep - 1e-9) + 1;
+    unsigned nt = (m_opt.pktMax - m_opt.pktMin + m_opt.minPktStep - 1) / m_opt.minPktStep + 1;
+    return nr * nt;
+  }
+
+  /* Cascade boundary as polylines in (rho, PktLength). Each leaf cell with a
+   * disagreeing edge contributes a segment between the edge crossings, placed
+   * by linear interpolation of the victim throughput; segments sharing an end
+   * point are then chained. An edge shared with finer neighbours is split at
+   * their corners (the hanging nodes), so both sides see the same sub-edges
+   * and place their crossings at the same points.
+   */
+  std::vector<Polyline> GetBoundary () const {
+    std::vector<std::pair<Pt, Pt> > segments;
+    for (size_t k = 0; k < m_leaves.size (); ++k){
+      const Cell &c = m_leaves[k];
+      PhaseSample s[4] = {Sample (c.r0, c.t0), Sample (c.r1, c.t0), Sample (c.r1, c.t1), Sample (c.r0, c.t1)};
+      std::vector<Pt> crossings;
+      for (int e = 0; e < 4; ++e){
+        std::vector<PhaseSample> edge = EdgeSamples (s[e], s[(e + 1) % 4]);
+        for (size_t i = 0; i + 1 < edge.size (); ++i){
+          const PhaseSample &a = edge[i];
+          const PhaseSample &b = edge[i + 1];
+          if (!a.known || !b.known || a.cascade == b.cascade){
+            continue;
+          }
+          double f = 0.5;
+          if (std::fabs (b.victim - a.victim) > 1e-12){
+            f = (m_opt.level - a.victim) / (b.victim - a.victim);
+            f = f < 0 ? 0 : (f > 1 ? 1 : f);
+          }
+          crossings.push_back (Pt (a.rho + f * (b.rho - a.rho), a.pktLength + f * ((double)b.pktLength - a.pktLength)));
+        }
+      }
+      for (size_t i = 0; i + 1 < crossings.size (); i += 2){
+        segments.push_back (std::make_pair (crossings[i], crossings[i + 1]));
+      }
+    }
+
+    std::vector<Polyline> lines;
+    std::vector<bool> used (segments.size (), false);
+    for (size_t k = 0; k < segments.size (); ++k){
+      if (used[k]){
+        continue;
+      }
+      used[k] = true;
+      Polyline line;
+      line.push_back (segments[k].first);
+      line.push_back (segments[k].second);
+      bool grown = true;
+      while (grown){
+        grown = false;
+        for (size_t j = 0; j < segments.size (); ++j){
+          if (used[j]){
+            continue;
+          }
+          const Pt &a = segments[j].first;
+          const Pt &b = segments[j].second;
+          if (Same (line.back (), a)) line.push_back (b);
+          else if (Same (line.back (), b)) line.push_back (a);
+          else if (Same (line.front (), a)) line.insert (line.begin (), b);
+          else if (Same (line.front (), b)) line.insert (line.begin (), a);
+          else continue;
+          used[j] = true;
+          grown = true;
+        }
+      }
+      lines.push_back (line);
+    }
+    return lines;
+  }
+
+private:
+  struct Cell { double r0, r1; uint16_t t0, t1; };
+  typedef std::pair<long long, uint16_t> Key;
+  typedef std::pair<double, double> Pt;
+
+  static Key MakeKey (double rho, uint16_t t){
+    return Key (std::llround (rho * 1e6), t);
+  }
+
+  PhaseSample Sample (double rho, uint16_t t) const {
+    return m_samples.find (MakeKey (rho, t))->second;
+  }
+
+  // Samples on the edge from a to b in that order, both ends included.
+  std::vector<PhaseSample> EdgeSamples (const PhaseSample &a, const PhaseSample &b) const {
+    std::vector<PhaseSample> edge (1, a);
+    Key ka = MakeKey (a.rho, a.pktLength), kb = MakeKey (b.rho, b.pktLength);
+    Key lo = std::min (ka, kb), hi = std::max (ka, kb);
+    std::map<Key, PhaseSample>::const_iterator it = m_samples.upper_bound (lo);
+    for (; it != m_samples.end () && it->first < hi; ++it){
+      // along PktLength the keys in between share rho; along rho they must share PktLength
+      if ((ka.first == kb.first && it->first.first == ka.first) || (ka.second == kb.second && it->first.second == ka.second)){
+        edge.push_back (it->second);
+      }
+    }
+    if (kb < ka){
+      std::reverse (edge.begin () + 1, edge.end ());
+    }
+    edge.push_back (b);
+    return edge;
+  }
+
+  bool Same (const Pt &a, const Pt &b) const {
+    return std::fabs (a.first - b.first) < 1e-6 * (m_opt.rhoMax - m_opt.rhoMin)
+      && std::fabs (a.second - b.second) < 1e-3;
+  }
+
+  bool NeedsSplit (const Cell &c) const {
+    PhaseSample s[4] = {Sample (c.r0, c.t0), Sample (c.r1, c.t0), Sample (c.r1, c.t1), Sample (c.r0, c.t1)};
+    const PhaseSample *first = NULL;
+    double lo = 0, hi = 0;
+    for (int i = 0; i < 4; ++i){
+      if (!s[i].known){
+        continue;
+      }
+      if (first == NULL){
+        first = &s[i];
+        lo = hi = s[i].victim;
+      }else if (s[i].cascade != first->cascade){
+        return true;
+      }
+      lo = s[i].victim < lo ? s[i].victim : lo;
+      hi = s[i].victim > hi ? s[i].victim : hi;
+    }
+    return hi - lo > m_opt.maxGradient;
+  }
+
+  // Evaluates, as one batch, the corners of the cells that are not known yet.
+  void EvaluateCorners (const std::vector<Cell> &cells){
+    std::vector<PhasePoint> todo;
+    std::map<Key, bool> queued;
+    for (size_t k = 0; k < cells.size (); ++k){
+      const Cell &c = cells[k];
+      PhasePoint corners[4] = {PhasePoint (c.r0, c.t0), PhasePoint (c.r1, c.t0),
+                               PhasePoint (c.r1, c.t1), PhasePoint (c.r0, c.t1)};
+      for (int i = 0; i < 4; ++i){
+        Key key = MakeKey (corners[i].first, corners[i].second);
+        if (m_samples.count (key) || queued.count (key)){
+          continue;
+        }
+        queued[key] = true;
+        todo.push_back (corners[i]);
+      }
+    }
+    for (unsigned attempt = 0; !todo.empty () && attempt <= m_opt.retries; ++attempt){
+      std::vector<PhaseSample> got = m_eval (todo, attempt);
+      m_runs += todo.size ();
+      std::vector<PhasePoint> again;
+      for (size_t i = 0; i < todo.size (); ++i){
+        // a lost run is unknown, not a negative, and is evaluated again
+        PhaseSample s = {0, 0, false, false, 1};
+        if (i < got.size ()){
+          s = got[i];
+        }
+        s.rho = todo[i].first;
+        s.pktLength = todo[i].second;
+        m_samples[MakeKey (s.rho, s.pktLength)] = s;
+        if (!s.known){
+          again.push_back (todo[i]);
+        }
+      }
+      todo.swap (again);
+    }
+  }
+
+  PhaseMapOptions m_opt;
+  PhaseEvaluator m_eval;
+  std::map<Key, PhaseSample> m_samples;
+  std::vector<Cell> m_leaves;
+  unsigned m_runs;
+};
+
+#endif /* CDOS_PHASE_MAP_H */
@@ -0,0 +1,164 @@
+/* Joint search of per-node transmit power and carrier-sense threshold.
+ *
+ * Candidates are scored on the static loss matrix with TopologyAnalyser, so
+ * thousands of them cost less than one simulated second. A candidate is only
+ * admissible when every flow can still decode its frames and acknowledgements,
+ * which also need to reach the energy-detection threshold of the receiver.
+ * Among those the score first removes hidden-terminal relations (the longest
+ * cascade chain weighs most), then maximises spatial reuse: the number of flow
+ * pairs whose senders neither sense nor corrupt each other and may transmit at
+ * once. Ties go to the setting closest to the default.
+ *
+ * The search is a coordinate descent over the discrete power and threshold
+ * levels of every node from the default setting and from random starts; the
+ * distinct local optima are returned best first for confirmation by
+ * simulation.
+ */
+#ifndef CDOS_POWER_TUNING_H
+#define CDOS_POWER_TUNING_H
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "cdos-topology.h"
+
+struct PowerTuningOptions {
+  std::vector<double> powerLevels;      // dBm
+  std::vector<double> thresholdLevels;  // dBm
+  unsigned restarts;
+  unsigned seed;
+
+  PowerTuningOptions () : restarts (20), seed (1){
+    for (double p = 0; p <= 20; p += 2){
+      powerLevels.push_back (p);
+    }
+    for (double t = -99; t <= -60; t += 3){
+      thresholdLevels.push_back (t);
+    }
+    powerLevels.push_back (16.0206);
+    thresholdLevels.push_back (-99);
+    std::sort (powerLevels.begin (), powerLevels.end ());
+    std::sort (thresholdLevels.begin (), thresholdLevels.end ());
+  }
+};
+
+struct PowerCandidate {
+  std::vector<double> txPower;
+  std::vector<double> ccaThreshold;
+  bool admissible;
+  size_t hidden;     // hidden-terminal relations
+  size_t chain;      // longest cascade chain, in flows hit
+  size_t reuse;      // flow pairs that may transmit at once
+  double score;
+  double deviation;  // dB changed from the default setting, summed over nodes
+};
+
+class PowerTuner {
+public:
+  PowerTuner (const LossMatrix &loss, const LinkBudget &base, const PowerTuningOptions &options)
+    : m_loss (loss), m_base (base), m_options (options) {}
+
+  PowerCandidate Evaluate (const std::vector<double> &txPower, const std::vector<double> &ccaThreshold) const {
+    LinkBudget budget = m_base;
+    budget.txPower = txPower;
+    budget.ccaThreshold = ccaThreshold;
+    TopologyAnalyser analyser (m_loss, budget);
+    PowerCandidate c;
+    c.txPower = txPower;
+    c.ccaThreshold = ccaThreshold;
+    c.admissible = true;
+    for (size_t f = 0; f < analyser.GetFlows (); ++f){
+      // data frames and the acknowledgements coming back, both above the
+      // receiving PHY's ED threshold, below which YansWifiPhy drops a frame
+      c.admissible = c.admissible && analyser.CanDecode (f)
+        && analyser.RxPower (2 * f + 1, 2 * f) - budget.noise >= budget.sinrThreshold
+        && analyser.RxPower (2 * f, 2 * f + 1) >= budget.EdThreshold (2 * f + 1)
+        && analyser.RxPower (2 * f + 1, 2 * f) >= budget.EdThreshold (2 * f);
+    }
+    c.hidden = analyser.HiddenEdges ().size ();
+    c.chain = analyser.LongestChain ();
+    c.reuse = 0;
+    for (size_t f = 0; f < analyser.GetFlows (); ++f){
+      for (size_t g = f + 1; g < analyser.GetFlows (); ++g){
+        bool sense = analyser.Senses (2 * f, 2 * g) || analyser.Senses (2 * g, 2 * f);
+        bool harm = analyser.Sinr (f, 2 * g) < budget.sinrThreshold || analyser.Sinr (g, 2 * f) < budget.sinrThreshold;
+        c.reuse += !sense && !harm;
+      }
+    }
+    double pairs = analyser.GetFlows () * analyser.GetFlows () + 1;
+    c.score = (c.admissible ? 0 : -1e9) - pairs * pairs * c.chain - pairs * c.hidden + c.reuse;
+    c.deviation = 0;
+    for (size_t i = 0; i < m_loss.size (); ++i){
+      c.deviation += std::fabs (budget.TxPower (i) - m_base.TxPower (i)) + std::fabs (budget.CcaThreshold (i) - m_base.CcaThreshold (i));
+    }
+    return c;
+  }
+
+  // Distinct local optima, best first.
+  std::vector<PowerCandidate> Search () const {
+    size_t n = m_loss.size ();
+    std::mt19937 rng (m_options.seed);
+    std::vector<PowerCandidate> optima;
+    for (unsigned r = 0; r <= m_options.restarts; ++r){
+      std::vector<double> power (n, m_base.defaultTxPower), threshold (n, m_base.defaultCcaThreshold);
+      if (r > 0){
+        for (size_t i = 0; i < n; ++i){
+          power[i] = m_options.powerLevels[rng () % m_options.powerLevels.size ()];
+          threshold[i] = m_options.thresholdLevels[rng () % m_options.thresholdLevels.size ()];
+        }
+      }
+      PowerCandidate best = Descend (power, threshold);
+      bool known = false;
+      for (size_t k = 0; k < optima.size (); ++k){
+        known = known || (optima[k].txPower == best.txPower && optima[k].ccaThreshold == best.ccaThreshold);
+      }
+      if (!known){
+        optima.push_back (best);
+      }
+    }
+    std::stable_sort (optima.begin (), optima.end (), [] (const PowerCandidate &a, const PowerCandidate &b){
+      return Better (a, b);
+    });
+    return optima;
+  }
+
+private:
+  static bool Better (const PowerCandidate &a, const PowerCandidate &b){
+    return a.score > b.score || (a.score == b.score && a.deviation < b.deviation);
+  }
+
+  PowerCandidate Descend (std::vector<double> power, std::vector<double> threshold) const {
+    PowerCandidate best = Evaluate (power, threshold);
+    for (bool improved = true; improved; ){
+      improved = false;
+      for (size_t i = 0; i < power.size (); ++i){
+        for (size_t k = 0; k < m_options.powerLevels.size (); ++k){
+          std::vector<double> p = best.txPower;
+          p[i] = m_options.powerLevels[k];
+          PowerCandidate c = Evaluate (p, best.ccaThreshold);
+          if (Better (c, best)){
+            best = c;
+            improved = true;
+          }
+        }
+        for (size_t k = 0; k < m_options.thresholdLevels.size (); ++k){
+          std::vector<double> t = best.ccaThreshold;
+          t[i] = m_options.thresholdLevels[k];
+          PowerCandidate c = Evaluate (best.txPower, t);
+          if (Better (c, best)){
+            best = c;
+            improved = true;
+          }
+        }
+      }
+    }
+    return best;
+  }
+
+  LossMatrix m_loss;
+  LinkBudget m_base;
+  PowerTuningOptions m_options;
+};
+
+#endif /* CDOS_POWER_TUNING_H */
@@ -0,0 +1,133 @@
+/* Live progress of running experiments over a Unix domain socket.
+ *
+ * Every worker sends one line per report as a datagram to a socket bound by
+ * a listener (the dashboard mode, or `socat UNIX-RECVFROM:<path>,fork -`).
+ * Lines are space-separated key=value pairs; the last line of a run carries
+ * done=1 so the listener can drop it. When no listener is bound,
+ * sending fails at once; the publisher then stays quiet and only re-checks
+ * the path once per wall-clock second, so an unwatched run pays one stat()
+ * per second at most.
+ */
+#ifndef CDOS_PROGRESS_H
+#define CDOS_PROGRESS_H
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+class ProgressPublisher {
+public:
+  ProgressPublisher () : m_fd (-1), m_listening (false) {}
+  ~ProgressPublisher (){
+    if (m_fd >= 0){
+      close (m_fd);
+    }
+  }
+
+  void Open (const std::string &path){
+    m_path = path;
+    m_fd = socket (AF_UNIX, SOCK_DGRAM, 0);
+    if (m_fd >= 0){
+      fcntl (m_fd, F_SETFL, O_NONBLOCK);
+    }
+    std::memset (&m_addr, 0, sizeof (m_addr));
+    m_addr.sun_family = AF_UNIX;
+    std::strncpy (m_addr.sun_path, path.c_str (), sizeof (m_addr.sun_path) - 1);
+    m_checked = std::chrono::steady_clock::now () - std::chrono::seconds (1);
+  }
+
+  // Cheap test to call before formatting a report.
+  bool IsListening (){
+    if (m_fd < 0){
+      return false;
+    }
+    if (m_listening){
+      return true;
+    }
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+    if (now - m_checked < std::chrono::seconds (1)){
+      return false;
+    }
+    m_checked = now;
+    struct stat st;
+    m_listening = stat (m_path.c_str (), &st) == 0 && S_ISSOCK (st.st_mode);
+    return m_listening;
+  }
+
+  void Publish (const std::string &line){
+    if (!IsListening ()){
+      return;
+    }
+    std::string msg = line + "\n";
+    if (sendto (m_fd, msg.data (), msg.size (), MSG_DONTWAIT, (struct sockaddr *)&m_addr, sizeof (m_addr)) < 0
+        && errno != EAGAIN && errno != EWOULDBLOCK){
+      // listener gone: back off until the next check
+      m_listening = false;
+      m_checked = std::chrono::steady_clock::now ();
+    }
+  }
+
+private:
+  int m_fd;
+  bool m_listening;
+  std::string m_path;
+  struct sockaddr_un m_addr;
+  std::chrono::steady_clock::time_point m_checked;
+};
+
+// Listener side: binds the path and returns one datagram per call.
+class ProgressListener {
+public:
+  ProgressListener () : m_fd (-1) {}
+  ~ProgressListener (){
+    if (m_fd >= 0){
+      close (m_fd);
+      unlink (m_path.c_str ());
+    }
+  }
+
+  bool Bind (const std::string &path){
+    m_path = path;
+    unlink (path.c_str ());
+    m_fd = socket (AF_UNIX, SOCK_DGRAM, 0);
+    struct sockaddr_un addr;
+    std::memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy (addr.sun_path, path.c_str (), sizeof (addr.sun_path) - 1);
+    return m_fd >= 0 && bind (m_fd, (struct sockaddr *)&addr, sizeof (addr)) == 0;
+  }
+
+  // True when a datagram is waiting, false after the timeout.
+  bool Wait (double seconds){
+    struct pollfd p;
+    p.fd = m_fd;
+    p.events = POLLIN;
+    return poll (&p, 1, (int)(seconds * 1000)) > 0;
+  }
+
+  bool Receive (std::string &line){
+    char buf[4096];
+    ssize_t n = recv (m_fd, buf, sizeof (buf), 0);
+    if (n <= 0){
+      return false;
+    }
+    line.assign (buf, n);
+    while (!line.empty () && line[line.size () - 1] == '\n'){
+      line.erase (line.size () - 1);
+    }
+    return true;
+  }
+
+private:
+  int m_fd;
+  std::string m_path;
+};
+
+#endif /* CDOS_PROGRESS_H */
@@ -0,0 +1,333 @@
+/* Shared-memory result rings between sweep workers and the aggregator.
+ *
+ * RunRing starts one long-lived worker process per slot. Workers claim job
+ * indices from a counter in shared memory, run each job in a forked child as
+ * the queue workers do, and the child pushes the outcome as a fixed-size
+ * record into its worker's single-producer/single-consumer ring. Only one
+ * child of a worker runs at a time, so each ring has one producer at any
+ * moment. The parent is the single consumer of all rings: it merges the
+ * records into running statistics and hands them to the persist callback in
+ * batches, so no file is touched per run.
+ *
+ * The memory comes from shm_open, is unlinked right away and reaches the
+ * workers through fork, so nothing is left in /dev/shm if a process dies.
+ * Head and tail are only ever written by the producer and the consumer
+ * respectively, with release stores and acquire loads.
+ */
+#ifndef CDOS_RESULT_RING_H
+#define CDOS_RESULT_RING_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cdos-experiment.h"
+
+// Maps size bytes of anonymous POSIX shared memory that survives fork.
+inline void *MapSharedMemory (size_t size){
+  std::ostringstream name;
+  name << "/cdos-ring-" << getpid () << "-" << rand ();
+  int fd = shm_open (name.str ().c_str (), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0){
+    perror ("shm_open");
+    exit (1);
+  }
+  shm_unlink (name.str ().c_str ());
+  if (ftruncate (fd, size) != 0){
+    perror ("ftruncate");
+    exit (1);
+  }
+  void *p = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (p == MAP_FAILED){
+    perror ("mmap");
+    exit (1);
+  }
+  return p;
+}
+
+template <typename T>
+class SpscRing {
+public:
+  // Capacity is rounded up to a power of two.
+  explicit SpscRing (size_t capacity){
+    m_capacity = 1;
+    while (m_capacity < capacity){
+      m_capacity <<= 1;
+    }
+    m_size = sizeof (Header) + m_capacity * sizeof (T);
+    m_header = (Header *)MapSharedMemory (m_size);
+    m_slots = (T *)(m_header + 1);
+  }
+
+  ~SpscRing (){
+    munmap (m_header, m_size);
+  }
+
+  // Producer: blocks while the ring is full.
+  void Push (const T &record){
+    uint64_t head = __atomic_load_n (&m_header->head, __ATOMIC_RELAXED);
+    while (head - __atomic_load_n (&m_header->tail, __ATOMIC_ACQUIRE) >= m_capacity){
+      sched_yield ();
+    }
+    memcpy (&m_slots[head & (m_capacity - 1)], &record, sizeof (T));
+    __atomic_store_n (&m_header->head, head + 1, __ATOMIC_RELEASE);
+  }
+
+  // Consumer: false when the ring is empty.
+  bool TryPop (T &record){
+    uint64_t tail = __atomic_load_n (&m_header->tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n (&m_header->head, __ATOMIC_ACQUIRE)){
+      return false;
+    }
+    memcpy (&record, &m_slots[tail & (m_capacity - 1)], sizeof (T));
+    __atomic_store_n (&m_header->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+private:
+  SpscRing (const SpscRing &);
+  SpscRing &operator= (const SpscRing &);
+
+  // head and tail on separate cache lines, so producer and consumer do not share one
+  struct Header {
+    alignas (64) uint64_t head;
+    alignas (64) uint64_t tail;
+  };
+
+  Header *m_header;
+  T *m_slots;
+  size_t m_capacity;
+  size_t m_size;
+};
+
+/* Outcome of one run in fixed-size form. The configuration is not carried:
+ * the aggregator knows it from the job index. Runs with more pairs than a
+ * record holds cannot use the rings.
+ */
+static const size_t RING_PAIRS = 32;
+static const int RECORD_ARRAYS = 11;
+
+struct ResultRecord {
+  uint64_t job;
+  uint8_t ok;           // 0 when the run died before reporting
+  uint8_t lengths[RECORD_ARRAYS];  // entries used in each array below
+  double values[RECORD_ARRAYS][RING_PAIRS];  // the vectors of ExperimentResult, in the order of RecordArray
+  double wallTime;
+  uint64_t phyEvents;
+  uint64_t packets;
+  uint64_t eventHash;
+  uint64_t events;
+  double simulatedTime;
+  double attackAirtime;
+  char truncated[16];
+};
+
+inline std::vector<double> *RecordArray (ExperimentResult &r, int k){
+  std::vector<double> *arrays[RECORD_ARRAYS] = {&r.throughput, &r.offered, &r.txFailure, &r.contentionWindow,
+                                                &r.delay, &r.alarm, &r.detectorPeak, &r.detectorPrePeak,
+                                                &r.perfSetup, &r.perfRun, &r.perfTeardown};
+  return arrays[k];
+}
+
+inline ResultRecord ToRecord (ExperimentResult r, size_t job){
+  ResultRecord record;
+  memset (&record, 0, sizeof (record));
+  record.job = job;
+  record.ok = !r.throughput.empty ();
+  for (int k = 0; k < RECORD_ARRAYS; ++k){
+    std::vector<double> *v = RecordArray (r, k);
+    record.lengths[k] = (uint8_t)std::min (v->size (), RING_PAIRS);
+    for (size_t i = 0; i < record.lengths[k]; ++i){
+      record.values[k][i] = (*v)[i];
+    }
+  }
+  record.wallTime = r.wallTime;
+  record.phyEvents = r.phyEvents;
+  record.packets = r.packets;
+  record.eventHash = r.eventHash;
+  record.events = r.events;
+  record.simulatedTime = r.simulatedTime;
+  record.attackAirtime = r.attackAirtime;
+  strncpy (record.truncated, r.truncated.c_str (), sizeof (record.truncated) - 1);
+  return record;
+}
+
+inline ExperimentResult FromRecord (const ResultRecord &record, const ExperimentConfig &config){
+  ExperimentResult r;
+  r.config = config;
+  for (int k = 0; k < RECORD_ARRAYS; ++k){
+    RecordArray (r, k)->assign (record.values[k], record.values[k] + record.lengths[k]);
+  }
+  r.wallTime = record.wallTime;
+  r.phyEvents = record.phyEvents;
+  r.packets = record.packets;
+  r.eventHash = record.eventHash;
+  r.events = record.events;
+  r.simulatedTime = record.simulatedTime;
+  r.attackAirtime = record.attackAirtime;
+  r.truncated = record.truncated;
+  return r;
+}
+
+// Running mean and variance (Welford) of one quantity.
+struct RunningStats {
+  uint64_t n;
+  double mean, m2;
+
+  RunningStats () : n (0), mean (0), m2 (0) {}
+
+  void Add (double x){
+    n++;
+    double d = x - mean;
+    mean += d / n;
+    m2 += d * (x - mean);
+  }
+
+  double Variance () const { return n > 1 ? m2 / (n - 1) : 0; }
+};
+
+struct RingSummary {
+  uint64_t runs, failed, truncated, cascades, batches;
+  RunningStats victim, total, wallTime;  // victim and total over the runs with a verdict
+
+  RingSummary () : runs (0), failed (0), truncated (0), cascades (0), batches (0) {}
+};
+
+/* Runs job(i) for every configuration on `workers` worker processes, handing
+ * the jobs out in the given order, and returns the results in configuration
+ * order; a run that died keeps only its configuration. persist receives the
+ * results in batches of up to batch runs as they arrive.
+ */
+inline std::vector<ExperimentResult> RunRing (const std::vector<ExperimentConfig> &configs, unsigned workers,
+                                              const std::function<ExperimentResult (size_t)> &job,
+                                              const std::vector<size_t> &order,
+                                              const std::function<void (const std::vector<ExperimentResult> &)> &persist,
+                                              size_t batch, double tolerance, RingSummary &summary){
+  size_t n = configs.size ();
+  workers = workers == 0 ? 1 : workers;
+  uint64_t *next = (uint64_t *)MapSharedMemory (sizeof (uint64_t));
+  *next = 0;
+  std::vector<SpscRing<ResultRecord> *> rings;
+  std::vector<pid_t> pids;
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (NULL);
+  for (unsigned w = 0; w < workers; ++w){
+    rings.push_back (new SpscRing<ResultRecord> (64));
+    pid_t pid = fork ();
+    if (pid < 0){
+      perror ("fork");
+      exit (1);
+    }
+    if (pid > 0){
+      pids.push_back (pid);
+      continue;
+    }
+    // 1. Worker: claim jobs until none are left, each in its own child
+    SpscRing<ResultRecord> *ring = rings.back ();
+    for (uint64_t k; (k = __atomic_fetch_add (next, 1, __ATOMIC_RELAXED)) < n; ){
+      size_t i = k < order.size () ? order[k] : k;
+      fflush (NULL);
+      pid_t child = fork ();
+      if (child == 0){
+        ring->Push (ToRecord (job (i), i));
+        std::cout.flush ();
+        _exit (0);
+      }
+      int status = 1;
+      if (child < 0 || waitpid (child, &status, 0) < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0){
+        ResultRecord failed;
+        memset (&failed, 0, sizeof (failed));
+        failed.job = i;
+        ring->Push (failed);
+      }
+    }
+    _exit (0);
+  }
+
+  // 2. Aggregator: drain the rings, merge the statistics, persist in batches
+  std::vector<ExperimentResult> results (n);
+  for (size_t i = 0; i < n; ++i){
+    results[i].config = configs[i];
+  }
+  std::vector<ExperimentResult> pending;
+  size_t received = 0;
+  std::vector<bool> exited (pids.size (), false);
+  bool finished = false;
+  while (received < n && !finished){
+    // checked before draining: whatever a worker pushed before exiting is seen in this pass
+    finished = true;
+    for (size_t w = 0; w < pids.size (); ++w){
+      exited[w] = exited[w] || waitpid (pids[w], NULL, WNOHANG) == pids[w];
+      finished = finished && exited[w];
+    }
+    bool idle = true;
+    ResultRecord record;
+    for (size_t w = 0; w < rings.size (); ++w){
+      while (rings[w]->TryPop (record)){
+        idle = false;
+        received++;
+        if (record.job >= n){
+          continue;
+        }
+        ExperimentResult &r = results[record.job];
+        if (record.ok){
+          r = FromRecord (record, configs[record.job]);
+          summary.runs++;
+          summary.wallTime.Add (r.wallTime);
+          if (HasVerdict (r)){
+            summary.cascades += IsCascade (r, tolerance);
+            summary.victim.Add (NormalizedThroughput (r, 0));
+            summary.total.Add (TotalThroughput (r));
+          }else{
+            summary.truncated++;
+          }
+        }else{
+          summary.failed++;
+        }
+        pending.push_back (r);
+        if (pending.size () >= batch){
+          persist (pending);
+          pending.clear ();
+          summary.batches++;
+        }
+      }
+    }
+    if (idle && !finished){
+      usleep (1000);
+    }
+  }
+  if (received < n){
+    std::cerr << "ring: workers ended with " << n - received << " runs unreported" << std::endl;
+  }
+  if (!pending.empty ()){
+    persist (pending);
+    summary.batches++;
+  }
+  for (size_t w = 0; w < pids.size (); ++w){
+    if (!exited[w]){
+      waitpid (pids[w], NULL, 0);
+    }
+  }
+  for (size_t w = 0; w < rings.size (); ++w){
+    delete rings[w];
+  }
+  munmap (next, sizeof (uint64_t));
+  return results;
+}
+
+#endif /* CDOS_RESULT_RING_H */
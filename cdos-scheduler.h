@@ -0,0 +1,184 @@
+/* Cost-aware ordering of sweep jobs.
+ *
+ * The wall-clock time of a run is close to proportional to the PHY events it
+ * simulates. CostModel fits the PHY events per simulated second by ridge
+ * regression on the result store, against the offered packet rate, the chain
+ * length, RTS/CTS and the MAC variants (QoS, fragmentation, shaper, queue
+ * management, channel plan), and turns events into seconds with the wall time
+ * per event of the same runs. The event count does not depend on the host, so
+ * the fit is not disturbed by runs from faster or busier machines. Jobs are then handed to the worker pool longest
+ * predicted first (LPT), which keeps the last straggler short.
+ */
+#ifndef CDOS_SCHEDULER_H
+#define CDOS_SCHEDULER_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "cdos-experiment.h"
+
+class CostModel {
+public:
+  enum { FEATURES = 10 };
+
+  CostModel () : m_fitted (false), m_samples (0), m_secondsPerEvent (0) {}
+
+  // Fits the model on the runs of a store that recorded a wall time.
+  bool Fit (const std::vector<ExperimentResult> &results, double ridge = 1e-3){
+    double a[FEATURES][FEATURES] = {{0}};
+    double b[FEATURES] = {0};
+    double wall = 0, events = 0;
+    m_samples = 0;
+    for (size_t i = 0; i < results.size (); ++i){
+      const ExperimentResult &r = results[i];
+      if (r.wallTime <= 0 || r.phyEvents == 0 || r.config.durationofSimulation == 0 || r.IsTruncated ()){
+        continue;
+      }
+      std::vector<double> x = Features (r.config);
+      double y = r.phyEvents / 1000.0 / r.config.durationofSimulation;
+      wall += r.wallTime;
+      events += r.phyEvents;
+      for (int p = 0; p < FEATURES; ++p){
+        for (int q = 0; q < FEATURES; ++q){
+          a[p][q] += x[p] * x[q];
+        }
+        b[p] += x[p] * y;
+      }
+      m_samples++;
+    }
+    if (m_samples < FEATURES){
+      m_fitted = false;
+      return false;
+    }
+    for (int p = 0; p < FEATURES; ++p){
+      a[p][p] += ridge * m_samples;
+    }
+    // Gaussian elimination with partial pivoting
+    for (int c = 0; c < FEATURES; ++c){
+      int pivot = c;
+      for (int r = c + 1; r < FEATURES; ++r){
+        if (std::fabs (a[r][c]) > std::fabs (a[pivot][c])){
+          pivot = r;
+        }
+      }
+      for (int q = 0; q < FEATURES; ++q){
+        std::swap (a[c][q], a[pivot][q]);
+      }
+      std::swap (b[c], b[pivot]);
+      for (int r = c + 1; r < FEATURES; ++r){
+        double f = a[r][c] / a[c][c];
+        for (int q = c; q < FEATURES; ++q){
+          a[r][q] -= f * a[c][q];
+        }
+        b[r] -= f * b[c];
+      }
+    }
+    for (int c = FEATURES - 1; c >= 0; --c){
+      double sum = b[c];
+      for (int q = c + 1; q < FEATURES; ++q){
+        sum -= a[c][q] * m_beta[q];
+      }
+      m_beta[c] = sum / a[c][c];
+    }
+    m_secondsPerEvent = wall / events;
+    m_fitted = true;
+    return true;
+  }
+
+  /* Predicted wall time in seconds. Without a fit the offered frame count is
+   * used as a relative cost, which is enough to order the jobs.
+   */
+  double Predict (const ExperimentConfig &c) const {
+    std::vector<double> x = Features (c);
+    if (!m_fitted){
+      return c.durationofSimulation * x[1];
+    }
+    return PredictEvents (c) * m_secondsPerEvent;
+  }
+
+  // Predicted PHY events of a run, 0 without a fit.
+  double PredictEvents (const ExperimentConfig &c) const {
+    if (!m_fitted){
+      return 0;
+    }
+    std::vector<double> x = Features (c);
+    double perSecond = 0;
+    for (int p = 0; p < FEATURES; ++p){
+      perSecond += m_beta[p] * x[p];
+    }
+    return c.durationofSimulation * 1000 * std::max (perSecond, 1e-6);
+  }
+
+  bool IsFitted () const { return m_fitted; }
+  size_t GetSamples () const { return m_samples; }
+
+private:
+  /* 1, offered frames per second (thousands), RTS share, chain length, the
+   * receptions per frame (nodes sharing its channel), the extra fragments, the
+   * attacker's share, and the variants: QoS MAC, the frames left to a shaper
+   * and CoDel above the MAC queue. A variant absent from the store keeps a
+   * zero weight through the ridge term.
+   */
+  static std::vector<double> Features (const ExperimentConfig &c){
+    double senders = c.numofNode / 2;
+    double load = c.restNodeLoad * (senders > 1 ? senders - 1 : 0) + c.firstNodeLoad;
+    double frames = load * 6e6 / (8.0 * std::max<uint16_t> (c.pktLength, 1)) / 1000;
+    double fragments = std::ceil ((double)c.pktLength / std::max<uint32_t> (c.fragThreshold, 1));
+    double shaped = c.shaperAuto ? c.shaperGain : c.shaperShare > 0 ? std::min (c.shaperShare * senders, 1.0) : 1;
+    std::vector<double> x (FEATURES);
+    x[0] = 1;
+    x[1] = frames;
+    x[2] = frames * c.enableCtsRts;
+    x[3] = c.numofNode;
+    x[4] = frames * c.numofNode / Channels (c);
+    x[5] = frames * (std::max (fragments, 1.0) - 1);
+    x[6] = c.firstNodeLoad * c.pktLength / 1500.0;
+    x[7] = c.qos;
+    x[8] = frames * (1 - shaped);
+    x[9] = c.aqm == "codel";
+    return x;
+  }
+
+  // Distinct channels of the pairs, pairs past the end of the plan on channel 0.
+  static double Channels (const ExperimentConfig &c){
+    std::vector<double> plan = SplitValues (c.channels);
+    plan.resize (std::max<size_t> (c.numofNode / 2, 1), 0);
+    std::sort (plan.begin (), plan.end ());
+    return (double)(std::unique (plan.begin (), plan.end ()) - plan.begin ());
+  }
+
+  bool m_fitted;
+  size_t m_samples;
+  double m_secondsPerEvent;  // wall time per PHY event over the fitted runs
+  double m_beta[FEATURES];   // thousands of PHY events per simulated second
+};
+
+// Job indices ordered by decreasing predicted cost.
+inline std::vector<size_t> LptOrder (const std::vector<double> &cost){
+  std::vector<size_t> order (cost.size ());
+  for (size_t i = 0; i < order.size (); ++i){
+    order[i] = i;
+  }
+  std::stable_sort (order.begin (), order.end (), [&cost] (size_t a, size_t b){ return cost[a] > cost[b]; });
+  return order;
+}
+
+// Makespan of list scheduling: each job in order goes to the first free worker.
+inline double ListMakespan (const std::vector<double> &cost, const std::vector<size_t> &order, unsigned workers){
+  std::priority_queue<double, std::vector<double>, std::greater<double> > free;
+  for (unsigned w = 0; w < std::max (workers, 1u); ++w){
+    free.push (0);
+  }
+  double makespan = 0;
+  for (size_t i = 0; i < order.size (); ++i){
+    double t = free.top () + cost[order[i]];
+    free.pop ();
+    free.push (t);
+    makespan = std::max (makespan, t);
+  }
+  return makespan;
+}
+
+#endif /* CDOS_SCHEDULER_H */
@@ -0,0 +1,171 @@
+/* Variance-based global sensitivity analysis (Sobol indices).
+ *
+ * Saltelli's scheme: two independent Latin hypercube matrices A and B of N
+ * rows over the k parameters, plus for every parameter i the matrix AB_i,
+ * which is A with column i taken from B. The N (k + 2) rows are simulated and
+ * the first-order and total indices are estimated with the Saltelli (2010)
+ * and Jansen estimators. Confidence intervals come from a bootstrap over the
+ * N row indices.
+ */
+#ifndef CDOS_SENSITIVITY_H
+#define CDOS_SENSITIVITY_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct SobolParameter {
+  std::string name;  // result store column, see SetResultField
+  double lo, hi;
+};
+
+struct SobolIndex {
+  double first, firstLo, firstHi;
+  double total, totalLo, totalHi;
+};
+
+// Parses "name:lo:hi,name:lo:hi,...".
+inline std::vector<SobolParameter> ParseSobolParameters (const std::string &spec){
+  std::vector<SobolParameter> params;
+  std::stringstream ss (spec);
+  std::string item;
+  while (std::getline (ss, item, ',')){
+    size_t a = item.find (':');
+    size_t b = item.find (':', a + 1);
+    if (a == std::string::npos || b == std::string::npos){
+      continue;
+    }
+    SobolParameter p;
+    p.name = item.substr (0, a);
+    p.lo = std::atof (item.substr (a + 1, b - a - 1).c_str ());
+    p.hi = std::atof (item.substr (b + 1).c_str ());
+    params.push_back (p);
+  }
+  return params;
+}
+
+/* Rows of the sample matrices, block after block: A, B, AB_1 .. AB_k. Row j
+ * of every block belongs to base sample j.
+ */
+inline std::vector<std::vector<double> > SaltelliSamples (const std::vector<SobolParameter> &params, size_t n, uint32_t seed){
+  size_t k = params.size ();
+  std::mt19937 rng (seed);
+  std::uniform_real_distribution<double> unit (0, 1);
+  std::vector<std::vector<double> > a (n, std::vector<double> (k)), b (n, std::vector<double> (k));
+  for (int m = 0; m < 2; ++m){
+    std::vector<std::vector<double> > &x = m ? b : a;
+    for (size_t d = 0; d < k; ++d){
+      std::vector<size_t> strata (n);
+      for (size_t j = 0; j < n; ++j){
+        strata[j] = j;
+      }
+      std::shuffle (strata.begin (), strata.end (), rng);
+      for (size_t j = 0; j < n; ++j){
+        double u = (strata[j] + unit (rng)) / n;
+        x[j][d] = params[d].lo + u * (params[d].hi - params[d].lo);
+      }
+    }
+  }
+  std::vector<std::vector<double> > rows (a);
+  rows.insert (rows.end (), b.begin (), b.end ());
+  for (size_t i = 0; i < k; ++i){
+    for (size_t j = 0; j < n; ++j){
+      std::vector<double> r = a[j];
+      r[i] = b[j][i];
+      rows.push_back (r);
+    }
+  }
+  return rows;
+}
+
+// Indices over the given base samples; y is laid out as SaltelliSamples.
+inline void SobolEstimate (const std::vector<double> &y, size_t n, size_t k, const std::vector<size_t> &rows,
+                           std::vector<double> &first, std::vector<double> &total){
+  double mean = 0, var = 0;
+  for (size_t r = 0; r < rows.size (); ++r){
+    mean += y[rows[r]] + y[n + rows[r]];
+  }
+  mean /= 2 * rows.size ();
+  for (size_t r = 0; r < rows.size (); ++r){
+    var += (y[rows[r]] - mean) * (y[rows[r]] - mean) + (y[n + rows[r]] - mean) * (y[n + rows[r]] - mean);
+  }
+  var /= 2 * rows.size ();
+  first.assign (k, 0);
+  total.assign (k, 0);
+  if (var <= 0){
+    return;
+  }
+  for (size_t i = 0; i < k; ++i){
+    double s = 0, t = 0;
+    for (size_t r = 0; r < rows.size (); ++r){
+      size_t j = rows[r];
+      double fa = y[j], fb = y[n + j], fab = y[(2 + i) * n + j];
+      s += fb * (fab - fa);
+      t += (fa - fab) * (fa - fab);
+    }
+    first[i] = s / rows.size () / var;
+    total[i] = 0.5 * t / rows.size () / var;
+  }
+}
+
+/* First-order and total indices with percentile bootstrap intervals at the
+ * given confidence. Base samples with a NaN output in any block are dropped.
+ */
+inline std::vector<SobolIndex> SobolIndices (const std::vector<double> &y, size_t n, size_t k,
+                                             unsigned bootstrap, double confidence, uint32_t seed){
+  std::vector<size_t> valid;
+  for (size_t j = 0; j < n; ++j){
+    bool ok = true;
+    for (size_t m = 0; m < k + 2 && ok; ++m){
+      ok = !std::isnan (y[m * n + j]);
+    }
+    if (ok){
+      valid.push_back (j);
+    }
+  }
+  std::vector<double> first, total;
+  SobolEstimate (y, n, k, valid, first, total);
+
+  std::vector<std::vector<double> > bf (k), bt (k);
+  std::mt19937 rng (seed);
+  std::uniform_int_distribution<size_t> pick (0, valid.empty () ? 0 : valid.size () - 1);
+  for (unsigned b = 0; b < bootstrap && !valid.empty (); ++b){
+    std::vector<size_t> rows (valid.size ());
+    for (size_t r = 0; r < rows.size (); ++r){
+      rows[r] = valid[pick (rng)];
+    }
+    std::vector<double> f, t;
+    SobolEstimate (y, n, k, rows, f, t);
+    for (size_t i = 0; i < k; ++i){
+      bf[i].push_back (f[i]);
+      bt[i].push_back (t[i]);
+    }
+  }
+
+  std::vector<SobolIndex> indices (k);
+  double alpha = (1 - confidence) / 2;
+  for (size_t i = 0; i < k; ++i){
+    SobolIndex &s = indices[i];
+    s.first = s.firstLo = s.firstHi = first[i];
+    s.total = s.totalLo = s.totalHi = total[i];
+    if (bf[i].empty ()){
+      continue;
+    }
+    std::sort (bf[i].begin (), bf[i].end ());
+    std::sort (bt[i].begin (), bt[i].end ());
+    size_t lo = (size_t)(alpha * (bf[i].size () - 1));
+    size_t hi = (size_t)((1 - alpha) * (bf[i].size () - 1));
+    s.firstLo = bf[i][lo];
+    s.firstHi = bf[i][hi];
+    s.totalLo = bt[i][lo];
+    s.totalHi = bt[i][hi];
+  }
+  return indices;
+}
+
+#endif /* CDOS_SENSITIVITY_H */
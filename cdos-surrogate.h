@@ -0,0 +1,410 @@
+/* Gaussian-process surrogate of experiment() trained on the result store.
+ *
+ * Inputs are (RestNodeLoad, PktLength, FirstNodeLoad, RTS) scaled to the unit
+ * box of the training data; inputs that do not vary in the store are ignored.
+ * Outputs are the per-pair throughput and the normalised victim throughput.
+ * All outputs share one squared-exponential kernel whose length scale and
+ * noise are picked by maximising the marginal likelihood of the victim
+ * throughput, so a single Cholesky factor serves every output. The cascade
+ * probability is the predictive mass of the victim throughput below the
+ * verdict threshold.
+ */
+#ifndef CDOS_SURROGATE_H
+#define CDOS_SURROGATE_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "cdos-experiment.h"
+
+struct SurrogatePrediction {
+  std::vector<double> throughput;    // Mbps per pair
+  std::vector<double> throughputSd;
+  double victim;                     // normalised victim throughput
+  double victimSd;
+  double cascadeProbability;
+};
+
+class Surrogate {
+public:
+  enum { FEATURES = 4 };
+  enum { MIN_POINTS = 5 };  // distinct inputs needed before the fit means anything
+
+  Surrogate () : m_length (0.2), m_noise (1e-2), m_level (0.9), m_pairs (0) {}
+
+  /* Trains on the runs of a set that share the scenario of base in every
+   * stored field but the inputs, seed and run; the store also holds other
+   * scenarios, screening runs and MAC variants. Runs with the same inputs are
+   * averaged first; if more than maxPoints distinct inputs remain, a
+   * space-filling subset is kept so that a query stays in the microsecond
+   * range. False when fewer than MIN_POINTS distinct inputs have a verdict.
+   */
+  bool Train (const std::vector<ExperimentResult> &all, const ExperimentConfig &base, double tolerance, size_t maxPoints = 400){
+    m_level = 1 - tolerance;
+    std::vector<ExperimentResult> results;
+    for (size_t i = 0; i < all.size (); ++i){
+      if (SameScenario (all[i].config, base)){
+        results.push_back (all[i]);
+      }
+    }
+    // 1. Keep the runs of the most common chain length among those with a verdict
+    std::map<size_t, size_t> pairCount;
+    for (size_t i = 0; i < results.size (); ++i){
+      if (HasVerdict (results[i])){
+        pairCount[results[i].throughput.size ()]++;
+      }
+    }
+    m_pairs = 0;
+    size_t best = 0;
+    for (std::map<size_t, size_t>::iterator it = pairCount.begin (); it != pairCount.end (); ++it){
+      if (it->first > 0 && it->second > best){
+        best = it->second;
+        m_pairs = it->first;
+      }
+    }
+    if (m_pairs == 0){
+      return false;
+    }
+
+    // 2. Average the replications of each input
+    std::map<std::vector<double>, std::pair<std::vector<double>, unsigned> > groups;
+    for (size_t i = 0; i < results.size (); ++i){
+      if (results[i].throughput.size () != m_pairs || !HasVerdict (results[i])){
+        continue;
+      }
+      std::vector<double> y = results[i].throughput;
+      y.push_back (NormalizedThroughput (results[i], 0));
+      std::pair<std::vector<double>, unsigned> &g = groups[RawFeatures (results[i].config)];
+      if (g.first.empty ()){
+        g.first.assign (y.size (), 0);
+      }
+      for (size_t k = 0; k < y.size (); ++k){
+        g.first[k] += y[k];
+      }
+      g.second++;
+    }
+    std::vector<std::vector<double> > raw, ys;
+    for (std::map<std::vector<double>, std::pair<std::vector<double>, unsigned> >::iterator it = groups.begin (); it != groups.end (); ++it){
+      raw.push_back (it->first);
+      for (size_t k = 0; k < it->second.first.size (); ++k){
+        it->second.first[k] /= it->second.second;
+      }
+      ys.push_back (it->second.first);
+    }
+
+    // 3. Scale the inputs to the unit box and thin them out
+    m_lo.assign (FEATURES, std::numeric_limits<double>::max ());
+    m_scale.assign (FEATURES, 0);
+    std::vector<double> hi (FEATURES, -std::numeric_limits<double>::max ());
+    for (size_t i = 0; i < raw.size (); ++i){
+      for (int d = 0; d < FEATURES; ++d){
+        m_lo[d] = std::min (m_lo[d], raw[i][d]);
+        hi[d] = std::max (hi[d], raw[i][d]);
+      }
+    }
+    for (int d = 0; d < FEATURES; ++d){
+      m_hi[d] = hi[d];
+      m_scale[d] = hi[d] > m_lo[d] ? 1 / (hi[d] - m_lo[d]) : 0;
+    }
+    std::vector<size_t> keep = SpaceFilling (raw, maxPoints);
+    m_x.clear ();
+    std::vector<std::vector<double> > y;
+    for (size_t i = 0; i < keep.size (); ++i){
+      m_x.push_back (Scale (raw[keep[i]]));
+      y.push_back (ys[keep[i]]);
+    }
+    size_t n = m_x.size ();
+    size_t outputs = m_pairs + 1;
+    if (n < MIN_POINTS){
+      m_x.clear ();
+      return false;
+    }
+
+    // 4. Standardise the targets
+    m_mean.assign (outputs, 0);
+    m_sd.assign (outputs, 0);
+    for (size_t k = 0; k < outputs; ++k){
+      for (size_t i = 0; i < n; ++i){
+        m_mean[k] += y[i][k] / n;
+      }
+      for (size_t i = 0; i < n; ++i){
+        m_sd[k] += (y[i][k] - m_mean[k]) * (y[i][k] - m_mean[k]) / n;
+      }
+      m_sd[k] = m_sd[k] > 1e-12 ? std::sqrt (m_sd[k]) : 1;
+    }
+    std::vector<std::vector<double> > target (outputs, std::vector<double> (n));
+    for (size_t k = 0; k < outputs; ++k){
+      for (size_t i = 0; i < n; ++i){
+        target[k][i] = (y[i][k] - m_mean[k]) / m_sd[k];
+      }
+    }
+
+    // 5. Pick the hyper-parameters on the victim throughput
+    static const double lengths[] = {0.05, 0.1, 0.2, 0.3, 0.5, 1.0};
+    static const double noises[] = {1e-4, 1e-3, 1e-2, 1e-1};
+    double bestLik = -std::numeric_limits<double>::max ();
+    double bestLength = m_length, bestNoise = m_noise;
+    for (size_t a = 0; a < sizeof (lengths) / sizeof (lengths[0]); ++a){
+      for (size_t b = 0; b < sizeof (noises) / sizeof (noises[0]); ++b){
+        m_length = lengths[a];
+        m_noise = noises[b];
+        if (!Factor ()){
+          continue;
+        }
+        std::vector<double> alpha = Solve (target[m_pairs]);
+        double lik = 0;
+        for (size_t i = 0; i < n; ++i){
+          lik -= 0.5 * target[m_pairs][i] * alpha[i] + std::log (m_L[i * n + i]);
+        }
+        if (lik > bestLik){
+          bestLik = lik;
+          bestLength = m_length;
+          bestNoise = m_noise;
+        }
+      }
+    }
+    m_length = bestLength;
+    m_noise = bestNoise;
+    if (!Factor ()){
+      return false;
+    }
+    m_alpha.clear ();
+    for (size_t k = 0; k < outputs; ++k){
+      m_alpha.push_back (Solve (target[k]));
+    }
+    return true;
+  }
+
+  SurrogatePrediction Predict (const ExperimentConfig &c) const {
+    size_t n = m_x.size ();
+    std::vector<double> x = Scale (RawFeatures (c));
+    std::vector<double> k (n);
+    for (size_t i = 0; i < n; ++i){
+      k[i] = Kernel (x, m_x[i]);
+    }
+    // variance of the latent function: 1 - |L^-1 k|^2
+    std::vector<double> v (n);
+    double var = 1;
+    for (size_t i = 0; i < n; ++i){
+      double sum = k[i];
+      for (size_t j = 0; j < i; ++j){
+        sum -= m_L[i * n + j] * v[j];
+      }
+      v[i] = sum / m_L[i * n + i];
+      var -= v[i] * v[i];
+    }
+    double sd = std::sqrt (std::max (var, 0.0) + m_noise);
+
+    SurrogatePrediction p;
+    for (size_t o = 0; o <= m_pairs; ++o){
+      double mu = 0;
+      for (size_t i = 0; i < n; ++i){
+        mu += k[i] * m_alpha[o][i];
+      }
+      mu = m_mean[o] + m_sd[o] * mu;
+      if (o < m_pairs){
+        p.throughput.push_back (mu);
+        p.throughputSd.push_back (sd * m_sd[o]);
+      }else {
+        p.victim = mu;
+        p.victimSd = sd * m_sd[o];
+      }
+    }
+    p.cascadeProbability = 0.5 * std::erfc ((p.victim - m_level) / (p.victimSd * std::sqrt (2.0)));
+    return p;
+  }
+
+  /* Active learning: draws random candidates in the box of the training data
+   * and returns the k most informative ones. "uncertainty" ranks by the
+   * predictive spread of the victim throughput, "boundary" by the entropy of
+   * the cascade verdict. Picks closer than half a length scale to an earlier
+   * pick are skipped so that a batch spreads out.
+   */
+  std::vector<ExperimentConfig> Propose (const ExperimentConfig &base, size_t k, size_t candidates,
+                                         const std::string &acquisition, uint32_t seed) const {
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution<double> unit (0, 1);
+    std::vector<std::pair<double, std::vector<double> > > scored;
+    for (size_t i = 0; i < candidates; ++i){
+      std::vector<double> raw (FEATURES);
+      for (int d = 0; d < FEATURES; ++d){
+        raw[d] = m_lo[d] + unit (rng) * (m_hi[d] - m_lo[d]);
+      }
+      raw[1] = std::floor (raw[1] + 0.5);
+      raw[3] = std::floor (raw[3] + 0.5);
+      SurrogatePrediction p = Predict (ToConfig (base, raw));
+      double q = p.cascadeProbability;
+      double score = acquisition == "boundary"
+        ? -(q > 0 ? q * std::log (q) : 0) - (q < 1 ? (1 - q) * std::log (1 - q) : 0)
+        : p.victimSd;
+      scored.push_back (std::make_pair (score, raw));
+    }
+    std::sort (scored.begin (), scored.end (),
+               [] (const std::pair<double, std::vector<double> > &a, const std::pair<double, std::vector<double> > &b){
+                 return a.first > b.first;
+               });
+    std::vector<ExperimentConfig> picks;
+    std::vector<std::vector<double> > chosen;
+    for (size_t i = 0; i < scored.size () && picks.size () < k; ++i){
+      std::vector<double> x = Scale (scored[i].second);
+      bool close = false;
+      for (size_t j = 0; j < chosen.size () && !close; ++j){
+        close = Distance2 (x, chosen[j]) < 0.25 * m_length * m_length;
+      }
+      if (!close){
+        chosen.push_back (x);
+        picks.push_back (ToConfig (base, scored[i].second));
+      }
+    }
+    return picks;
+  }
+
+  size_t GetPoints () const { return m_x.size (); }
+  double GetLengthScale () const { return m_length; }
+  double GetNoise () const { return m_noise; }
+
+private:
+  // Equal in every stored configuration field except the inputs, seed and run.
+  static bool SameScenario (const ExperimentConfig &a, const ExperimentConfig &b){
+    ExperimentResult ra, rb;
+    ra.config = a;
+    rb.config = b;
+    std::vector<std::pair<std::string, std::string> > fa = ResultFields (ra), fb = ResultFields (rb);
+    for (size_t i = 0; i < fa.size () && fa[i].first != "throughput"; ++i){
+      const std::string &name = fa[i].first;
+      bool free = name == "rho" || name == "T" || name == "u0" || name == "rts" || name == "seed" || name == "run";
+      if (!free && fa[i].second != fb[i].second){
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static std::vector<double> RawFeatures (const ExperimentConfig &c){
+    std::vector<double> f (FEATURES);
+    f[0] = c.restNodeLoad;
+    f[1] = c.pktLength;
+    f[2] = c.firstNodeLoad;
+    f[3] = c.enableCtsRts;
+    return f;
+  }
+
+  static ExperimentConfig ToConfig (const ExperimentConfig &base, const std::vector<double> &raw){
+    ExperimentConfig c = base;
+    c.restNodeLoad = raw[0];
+    c.pktLength = (uint16_t)raw[1];
+    c.firstNodeLoad = raw[2];
+    c.enableCtsRts = raw[3] > 0.5;
+    return c;
+  }
+
+  std::vector<double> Scale (const std::vector<double> &raw) const {
+    std::vector<double> x (FEATURES);
+    for (int d = 0; d < FEATURES; ++d){
+      x[d] = (raw[d] - m_lo[d]) * m_scale[d];
+    }
+    return x;
+  }
+
+  static double Distance2 (const std::vector<double> &a, const std::vector<double> &b){
+    double d2 = 0;
+    for (size_t d = 0; d < a.size (); ++d){
+      d2 += (a[d] - b[d]) * (a[d] - b[d]);
+    }
+    return d2;
+  }
+
+  double Kernel (const std::vector<double> &a, const std::vector<double> &b) const {
+    return std::exp (-0.5 * Distance2 (a, b) / (m_length * m_length));
+  }
+
+  // Farthest-point subset of at most m inputs, in scaled coordinates.
+  std::vector<size_t> SpaceFilling (const std::vector<std::vector<double> > &raw, size_t m) const {
+    std::vector<size_t> keep;
+    if (raw.size () <= m){
+      for (size_t i = 0; i < raw.size (); ++i){
+        keep.push_back (i);
+      }
+      return keep;
+    }
+    std::vector<std::vector<double> > x;
+    for (size_t i = 0; i < raw.size (); ++i){
+      x.push_back (Scale (raw[i]));
+    }
+    std::vector<double> nearest (raw.size (), std::numeric_limits<double>::max ());
+    size_t pick = 0;
+    while (keep.size () < m){
+      keep.push_back (pick);
+      size_t far = pick;
+      for (size_t i = 0; i < x.size (); ++i){
+        nearest[i] = std::min (nearest[i], Distance2 (x[i], x[pick]));
+        if (nearest[i] > nearest[far]){
+          far = i;
+        }
+      }
+      pick = far;
+    }
+    return keep;
+  }
+
+  // Cholesky factor of K + noise I into m_L; false if not positive definite.
+  bool Factor (){
+    size_t n = m_x.size ();
+    m_L.assign (n * n, 0);
+    for (size_t i = 0; i < n; ++i){
+      for (size_t j = 0; j <= i; ++j){
+        double sum = Kernel (m_x[i], m_x[j]) + (i == j ? m_noise + 1e-9 : 0);
+        for (size_t k = 0; k < j; ++k){
+          sum -= m_L[i * n + k] * m_L[j * n + k];
+        }
+        if (i == j){
+          if (sum <= 0){
+            return false;
+          }
+          m_L[i * n + i] = std::sqrt (sum);
+        }else {
+          m_L[i * n + j] = sum / m_L[j * n + j];
+        }
+      }
+    }
+    return true;
+  }
+
+  // (K + noise I)^-1 y with the current factor.
+  std::vector<double> Solve (const std::vector<double> &y) const {
+    size_t n = m_x.size ();
+    std::vector<double> z (n), a (n);
+    for (size_t i = 0; i < n; ++i){
+      double sum = y[i];
+      for (size_t j = 0; j < i; ++j){
+        sum -= m_L[i * n + j] * z[j];
+      }
+      z[i] = sum / m_L[i * n + i];
+    }
+    for (size_t i = n; i-- > 0;){
+      double sum = z[i];
+      for (size_t j = i + 1; j < n; ++j){
+        sum -= m_L[j * n + i] * a[j];
+      }
+      a[i] = sum / m_L[i * n + i];
+    }
+    return a;
+  }
+
+  double m_length;
+  double m_noise;
+  double m_level;
+  size_t m_pairs;
+  std::vector<double> m_lo, m_scale;
+  double m_hi[FEATURES];
+  std::vector<std::vector<double> > m_x;
+  std::vector<double> m_L;
+  std::vector<std::vector<double> > m_alpha;
+  std::vector<double> m_mean, m_sd;
+};
+
+#endif /* CDOS_SURROGATE_H */
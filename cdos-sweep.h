@@ -0,0 +1,375 @@
+/* Process-level parallelism for the sweep modes.
+ *
+ * ns-3 keeps the simulator, the attribute defaults and the random streams in
+ * process-wide singletons, so concurrent experiment() runs need separate
+ * processes. Each job is run in a forked child that hands its result back to
+ * the parent as one line of text over a pipe.
+ *
+ * RunForked forks the children from the sweep process itself, so each child
+ * still binds the ns-3 symbols it calls and sets up the types it uses on its
+ * first run. RunZygote instead forks them from a zygote process that did one
+ * warm-up run first, so every job starts with all of that done.
+ */
+#ifndef CDOS_SWEEP_H
+#define CDOS_SWEEP_H
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+
+typedef std::function<std::string (size_t)> SweepJob;
+
+// Per job: s from the dispatch by the parent to the start of the job in its child, and s the job ran.
+struct JobTimes {
+  std::vector<double> latency;
+  std::vector<double> runtime;
+};
+
+inline double MonotonicSeconds (){
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Runs a job in a child, prefixing its output with the timing line when asked for.
+inline std::string TimedJob (const SweepJob &job, size_t id, double dispatched, bool timed){
+  double started = MonotonicSeconds ();
+  std::string out = job (id);
+  if (!timed){
+    return out;
+  }
+  std::ostringstream os;
+  os.precision (9);
+  os << started - dispatched << " " << MonotonicSeconds () - started << "\n" << out;
+  return os.str ();
+}
+
+// Strips the timing line of a TimedJob output into times.
+inline std::string TakeTimes (const std::string &out, size_t id, JobTimes *times){
+  size_t eol = out.find ('\n');
+  if (times == NULL || eol == std::string::npos){
+    return out;
+  }
+  std::istringstream is (out.substr (0, eol));
+  is >> times->latency[id] >> times->runtime[id];
+  return out.substr (eol + 1);
+}
+
+inline unsigned DefaultWorkers (){
+  long n = sysconf (_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (unsigned)n : 1;
+}
+
+// Grid values lo, lo+step, ..., up to and including hi.
+inline std::vector<double> Range (double lo, double hi, double step){
+  std::vector<double> v;
+  if (step <= 0){
+    v.push_back (lo);
+    return v;
+  }
+  for (unsigned i = 0; lo + i * step <= hi + step * 1e-9; ++i){
+    v.push_back (lo + i * step);
+  }
+  return v;
+}
+
+inline void WriteAll (int fd, const std::string &data){
+  size_t done = 0;
+  while (done < data.size ()){
+    ssize_t n = write (fd, data.data () + done, data.size () - done);
+    if (n < 0 && errno == EINTR){
+      continue;
+    }
+    if (n <= 0){
+      return;
+    }
+    done += n;
+  }
+}
+
+/* Runs job(0) .. job(n-1), each in its own forked child and at most `workers`
+ * at a time, in the given dispatch order (index order if empty). Slot i of the
+ * returned vector holds what job(i) returned, or an empty string if the child
+ * died before answering. If given, tick is called in the parent at least
+ * every tickInterval seconds while children are running; when it returns
+ * false the running children are killed and no further job is started.
+ * times receives the timing of every job.
+ */
+inline std::vector<std::string> RunForked (size_t n, unsigned workers, const SweepJob &job,
+                                           const std::vector<size_t> &order = std::vector<size_t> (),
+                                           const std::function<bool ()> &tick = std::function<bool ()> (),
+                                           double tickInterval = 1, JobTimes *times = NULL){
+  struct Child { pid_t pid; int fd; size_t job; std::string buf; };
+  std::vector<std::string> out (n);
+  if (times != NULL){
+    times->latency.assign (n, 0);
+    times->runtime.assign (n, 0);
+  }
+  std::vector<Child> running;
+  size_t next = 0;
+  if (workers == 0){
+    workers = 1;
+  }
+  while (next < n || !running.empty ()){
+    // 1. Keep every worker slot busy
+    while (next < n && running.size () < workers){
+      int fds[2];
+      if (pipe (fds) != 0){
+        perror ("pipe");
+        exit (1);
+      }
+      std::cout.flush ();
+      std::cerr.flush ();
+      fflush (NULL);
+      double dispatched = MonotonicSeconds ();
+      pid_t pid = fork ();
+      if (pid < 0){
+        perror ("fork");
+        exit (1);
+      }
+      size_t id = order.size () == n ? order[next] : next;
+      if (pid == 0){
+        close (fds[0]);
+        WriteAll (fds[1], TimedJob (job, id, dispatched, times != NULL));
+        close (fds[1]);
+        std::cout.flush ();
+        _exit (0);
+      }
+      close (fds[1]);
+      Child c;
+      c.pid = pid;
+      c.fd = fds[0];
+      c.job = id;
+      ++next;
+      running.push_back (c);
+    }
+
+    // 2. Collect output from whichever children are ready
+    fd_set readable;
+    FD_ZERO (&readable);
+    int maxfd = -1;
+    for (size_t i = 0; i < running.size (); ++i){
+      FD_SET (running[i].fd, &readable);
+      maxfd = running[i].fd > maxfd ? running[i].fd : maxfd;
+    }
+    struct timeval timeout;
+    timeout.tv_sec = (time_t)tickInterval;
+    timeout.tv_usec = (suseconds_t)((tickInterval - timeout.tv_sec) * 1e6);
+    int ready = select (maxfd + 1, &readable, NULL, NULL, tick ? &timeout : NULL);
+    if (tick && !tick ()){
+      for (size_t i = 0; i < running.size (); ++i){
+        kill (running[i].pid, SIGKILL);
+      }
+      next = n;
+    }
+    if (ready < 0){
+      if (errno == EINTR){
+        continue;
+      }
+      perror ("select");
+      exit (1);
+    }
+    for (size_t i = 0; i < running.size ();){
+      Child &c = running[i];
+      if (!FD_ISSET (c.fd, &readable)){
+        ++i;
+        continue;
+      }
+      char chunk[4096];
+      ssize_t got = read (c.fd, chunk, sizeof (chunk));
+      if (got < 0 && errno == EINTR){
+        ++i;
+        continue;
+      }
+      if (got > 0){
+        c.buf.append (chunk, got);
+        ++i;
+        continue;
+      }
+      // 3. End of stream: reap the child
+      close (c.fd);
+      int status;
+      waitpid (c.pid, &status, 0);
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0){
+        out[c.job] = TakeTimes (c.buf, c.job, times);
+      }
+      running.erase (running.begin () + i);
+    }
+  }
+  return out;
+}
+
+/* Zygote side of RunZygote: runs the warm-up, then forks one child per job
+ * index read from the command pipe. Each child sends its output as a single
+ * message "<id> 1\n<output>"; the zygote reports a child that failed as
+ * "<id> 0\n". Returns once the command pipe is closed and every child is
+ * reaped.
+ */
+inline void ZygoteLoop (int commands, int results, const SweepJob &job, const std::function<void ()> &warmup, bool timed){
+  if (warmup){
+    warmup ();
+  }
+  std::map<pid_t, size_t> children;
+  std::string pending;
+  bool open = true;
+  while (open || !children.empty ()){
+    // 1. Reap the children, reporting those that did not finish cleanly
+    int status;
+    pid_t pid;
+    while ((pid = waitpid (-1, &status, open ? WNOHANG : 0)) > 0){
+      if (!(WIFEXITED (status) && WEXITSTATUS (status) == 0) && children.count (pid)){
+        std::ostringstream os;
+        os << children[pid] << " 0\n";
+        send (results, os.str ().data (), os.str ().size (), 0);
+      }
+      children.erase (pid);
+      if (!open && children.empty ()){
+        break;
+      }
+    }
+    if (!open){
+      continue;
+    }
+
+    // 2. Wait briefly for job requests "<id> <dispatch time>"
+    fd_set readable;
+    FD_ZERO (&readable);
+    FD_SET (commands, &readable);
+    struct timeval timeout = {0, 10000};
+    if (select (commands + 1, &readable, NULL, NULL, &timeout) <= 0){
+      continue;
+    }
+    char chunk[4096];
+    ssize_t got = read (commands, chunk, sizeof (chunk));
+    if (got < 0 && errno == EINTR){
+      continue;
+    }
+    if (got <= 0){
+      open = false;
+      continue;
+    }
+    pending.append (chunk, got);
+
+    // 3. One child per complete request
+    for (size_t eol; (eol = pending.find ('\n')) != std::string::npos; pending.erase (0, eol + 1)){
+      std::istringstream is (pending.substr (0, eol));
+      size_t id;
+      double dispatched;
+      if (!(is >> id >> dispatched)){
+        continue;
+      }
+      fflush (NULL);
+      pid_t child = fork ();
+      if (child < 0){
+        perror ("fork");
+        std::ostringstream os;
+        os << id << " 0\n";
+        send (results, os.str ().data (), os.str ().size (), 0);
+        continue;
+      }
+      if (child == 0){
+        close (commands);
+        std::ostringstream os;
+        os << id << " 1\n" << TimedJob (job, id, dispatched, timed);
+        ssize_t sent = send (results, os.str ().data (), os.str ().size (), 0);
+        std::cout.flush ();
+        _exit (sent == (ssize_t)os.str ().size () ? 0 : 1);
+      }
+      children[child] = id;
+    }
+  }
+}
+
+/* Same contract as RunForked, but the children are forked from a zygote that
+ * ran warmup once beforehand, and return their results as messages on a
+ * SOCK_SEQPACKET socket, which keeps each one whole. The zygote is forked
+ * when called and ends when all jobs are done.
+ */
+inline std::vector<std::string> RunZygote (size_t n, unsigned workers, const SweepJob &job,
+                                           const std::function<void ()> &warmup,
+                                           const std::vector<size_t> &order = std::vector<size_t> (),
+                                           JobTimes *times = NULL){
+  std::vector<std::string> out (n);
+  if (times != NULL){
+    times->latency.assign (n, 0);
+    times->runtime.assign (n, 0);
+  }
+  int results[2], commands[2];
+  if (socketpair (AF_UNIX, SOCK_SEQPACKET, 0, results) != 0 || pipe (commands) != 0){
+    perror ("zygote");
+    exit (1);
+  }
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (NULL);
+  pid_t zygote = fork ();
+  if (zygote < 0){
+    perror ("fork");
+    exit (1);
+  }
+  if (zygote == 0){
+    close (results[0]);
+    close (commands[1]);
+    ZygoteLoop (commands[0], results[1], job, warmup, times != NULL);
+    std::cout.flush ();
+    _exit (0);
+  }
+  close (results[1]);
+  close (commands[0]);
+
+  workers = workers == 0 ? 1 : workers;
+  size_t next = 0, finished = 0, running = 0;
+  std::vector<char> message (1 << 20);
+  while (finished < n){
+    // 1. Keep every worker slot busy
+    for (; next < n && running < workers; ++next, ++running){
+      std::ostringstream os;
+      os.precision (17);
+      os << (order.size () == n ? order[next] : next) << " " << MonotonicSeconds () << "\n";
+      WriteAll (commands[1], os.str ());
+    }
+
+    // 2. One message per finished job
+    ssize_t got = recv (results[0], &message[0], message.size (), 0);
+    if (got < 0 && errno == EINTR){
+      continue;
+    }
+    if (got <= 0){
+      std::cerr << "zygote: ended with " << n - finished << " jobs unanswered" << std::endl;
+      break;
+    }
+    std::string text (&message[0], got);
+    size_t eol = text.find ('\n');
+    std::istringstream is (text.substr (0, eol));
+    size_t id;
+    int ok = 0;
+    if (eol == std::string::npos || !(is >> id >> ok) || id >= n){
+      continue;
+    }
+    if (ok){
+      out[id] = TakeTimes (text.substr (eol + 1), id, times);
+    }
+    finished++;
+    running--;
+  }
+  close (commands[1]);
+  close (results[0]);
+  int status;
+  waitpid (zygote, &status, 0);
+  return out;
+}
+
+#endif /* CDOS_SWEEP_H */
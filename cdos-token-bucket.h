@@ -0,0 +1,79 @@
+/* Airtime token bucket for the sender-side shaper.
+ *
+ * Tokens are seconds of airtime: they accrue at the airtime share granted to
+ * the sender (0.3 = 30 % of the channel) up to the burst size, and every
+ * packet costs the airtime of its frame exchange at the rates of the
+ * scenario. Capping airtime rather than bytes keeps the cap meaningful for
+ * any packet length.
+ *
+ * In self-tuning mode the share is re-derived every interval from what the
+ * sender hears of its neighbours: it may use a fixed fraction (the gain) of
+ * the airtime it did not sense busy. A sender surrounded by busy neighbours
+ * backs off, leaving room for the upstream pairs a saturated sender would
+ * otherwise starve.
+ */
+#ifndef CDOS_TOKEN_BUCKET_H
+#define CDOS_TOKEN_BUCKET_H
+
+#include <algorithm>
+#include <cmath>
+#include "cdos-airtime.h"
+
+class TokenBucket {
+public:
+  TokenBucket (double rate = 1, double burst = 0.01)
+    : m_rate (rate), m_burst (burst), m_tokens (burst), m_last (0) {}
+
+  void SetRate (double now, double rate){
+    Refill (now);
+    m_rate = rate;
+  }
+
+  double GetRate () const { return m_rate; }
+
+  // Takes the tokens for a packet if there are enough.
+  bool Take (double now, double cost){
+    Refill (now);
+    if (m_tokens + 1e-12 < std::min (cost, m_burst)){  // tolerate rounding of the refill
+      return false;
+    }
+    m_tokens -= cost;
+    return true;
+  }
+
+  // Time until a packet of this cost conforms.
+  double Wait (double now, double cost){
+    Refill (now);
+    double missing = std::min (cost, m_burst) - m_tokens;
+    return missing <= 1e-12 ? 0 : missing / std::max (m_rate, 1e-9) + 1e-9;
+  }
+
+private:
+  void Refill (double now){
+    m_tokens = std::min (m_burst, m_tokens + (now - m_last) * m_rate);
+    m_last = now;
+  }
+
+  double m_rate;    // airtime seconds per second
+  double m_burst;   // airtime seconds
+  double m_tokens;
+  double m_last;
+};
+
+/* Airtime (s) of one UDP packet exchange: DIFS, the mean backoff of CWmin 15,
+ * the data frame with UDP/IP/LLC/MAC overhead, SIFS and the acknowledgement,
+ * both at ERP-OFDM 6 Mbps (cdos-airtime.h).
+ */
+inline double ExchangeAirtime (double payload){
+  const double difs = SIFS_US + 2 * SLOT_US;
+  double data = ErpOfdmUs (payload + 8 + 20 + 8 + 28);
+  return (difs + 7.5 * SLOT_US + data + SIFS_US + ErpOfdmUs (ACK_BYTES)) * 1e-6;
+}
+
+// Self-tuned share: the gain times the airtime not sensed busy, within bounds.
+inline double TunedShare (double busyFraction, double gain, double minShare, double maxShare){
+  double share = gain * (1 - std::min (std::max (busyFraction, 0.0), 1.0));
+  return std::min (std::max (share, minShare), maxShare);
+}
+
+#endif /* CDOS_TOKEN_BUCKET_H */
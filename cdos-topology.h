@@ -0,0 +1,261 @@
+/* Static carrier-sense and hidden-terminal analysis of a layout.
+ *
+ * Works on the matrix of path losses between all nodes (dB, loss[i][j] from
+ * transmitter i to receiver j), so any placement and propagation model can be
+ * screened without running the simulator. Flows follow the convention of the
+ * scenario: node 2i sends to node 2i+1.
+ *
+ *  - Node j senses node i when i's power at j reaches j's CCA threshold.
+ *  - Sender h is a hidden terminal of flow f = (s -> r) when s cannot sense h
+ *    and the SINR of s at r with h on the air drops below the decoding
+ *    threshold.
+ *  - Flow g hits flow f when the sender of g is a hidden terminal of f. A
+ *    saturated g then makes f retransmit until f saturates itself, so a path
+ *    g -> f -> e in this graph is a potential cascade chain.
+ *
+ * The hit graph is computed once per analyser. Chains are searched to a depth
+ * limit: the longest one by a depth-first search pruned with a memoised bound
+ * on the walks left from each flow, and the listing stops after a number of
+ * chains, since a dense layout has exponentially many.
+ */
+#ifndef CDOS_TOPOLOGY_H
+#define CDOS_TOPOLOGY_H
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Radio parameters; defaults are those of YansWifiPhy in ns-3.22 at 6 Mbps.
+struct LinkBudget {
+  std::vector<double> txPower;       // dBm per node, default for all if empty
+  std::vector<double> ccaThreshold;  // dBm per node, default for all if empty
+  double defaultTxPower;
+  double defaultCcaThreshold;
+  double noise;                      // dBm over 20 MHz with a 7 dB noise figure
+  double sinrThreshold;              // dB needed to decode ErpOfdmRate6Mbps
+  double edThreshold;                // dBm, YansWifiPhy EnergyDetectionThreshold: weaker frames are dropped
+
+  LinkBudget ()
+    : defaultTxPower (16.0206), defaultCcaThreshold (-99), noise (-93.97), sinrThreshold (4), edThreshold (-96) {}
+
+  double TxPower (size_t i) const { return i < txPower.size () ? txPower[i] : defaultTxPower; }
+  double CcaThreshold (size_t i) const { return i < ccaThreshold.size () ? ccaThreshold[i] : defaultCcaThreshold; }
+  // experiment() raises the ED threshold to a higher carrier-sense threshold
+  double EdThreshold (size_t i) const { return std::max (edThreshold, CcaThreshold (i)); }
+};
+
+typedef std::vector<std::vector<double> > LossMatrix;
+
+class TopologyAnalyser {
+public:
+  TopologyAnalyser (const LossMatrix &loss, const LinkBudget &budget)
+    : m_loss (loss), m_budget (budget), m_graphed (false) {}
+
+  size_t GetNodes () const { return m_loss.size (); }
+  size_t GetFlows () const { return m_loss.size () / 2; }
+
+  double RxPower (size_t from, size_t to) const {
+    return m_budget.TxPower (from) - m_loss[from][to];
+  }
+
+  bool Senses (size_t listener, size_t talker) const {
+    return RxPower (talker, listener) >= m_budget.CcaThreshold (listener);
+  }
+
+  // SINR (dB) of flow f's frame at its receiver, with an optional interferer.
+  double Sinr (size_t f, int interferer = -1) const {
+    size_t s = 2 * f, r = 2 * f + 1;
+    double n = std::pow (10, m_budget.noise / 10);
+    if (interferer >= 0){
+      n += std::pow (10, RxPower (interferer, r) / 10);
+    }
+    return RxPower (s, r) - 10 * std::log10 (n);
+  }
+
+  bool CanDecode (size_t f) const {
+    return Sinr (f) >= m_budget.sinrThreshold;
+  }
+
+  bool IsHidden (size_t h, size_t f) const {
+    size_t s = 2 * f;
+    return h != s && h != 2 * f + 1 && !Senses (s, h) && Sinr (f, h) < m_budget.sinrThreshold;
+  }
+
+  // Flow g hits flow f: g's sender is a hidden terminal of f.
+  bool Hits (size_t g, size_t f) const {
+    return g != f && IsHidden (2 * g, f);
+  }
+
+  // Node pairs (i < j) in mutual or one-way carrier-sense range.
+  std::vector<std::pair<size_t, size_t> > CarrierSenseEdges () const {
+    std::vector<std::pair<size_t, size_t> > edges;
+    for (size_t i = 0; i < GetNodes (); ++i){
+      for (size_t j = i + 1; j < GetNodes (); ++j){
+        if (Senses (i, j) || Senses (j, i)){
+          edges.push_back (std::make_pair (i, j));
+        }
+      }
+    }
+    return edges;
+  }
+
+  // Flows that flow g hits, from the hit graph computed on first use.
+  const std::vector<size_t> &HitsFrom (size_t g) const {
+    if (!m_graphed){
+      m_hits.assign (GetFlows (), std::vector<size_t> ());
+      for (size_t a = 0; a < GetFlows (); ++a){
+        for (size_t f = 0; f < GetFlows (); ++f){
+          if (Hits (a, f)){
+            m_hits[a].push_back (f);
+          }
+        }
+      }
+      m_graphed = true;
+    }
+    return m_hits[g];
+  }
+
+  // (hidden sender, victim flow) pairs among the senders.
+  std::vector<std::pair<size_t, size_t> > HiddenEdges () const {
+    std::vector<std::pair<size_t, size_t> > edges;
+    for (size_t g = 0; g < GetFlows (); ++g){
+      for (size_t i = 0; i < HitsFrom (g).size (); ++i){
+        edges.push_back (std::make_pair (2 * g, HitsFrom (g)[i]));
+      }
+    }
+    return edges;
+  }
+
+  // Some flow hits a flow that hits a third one.
+  bool HasCascadeChain () const {
+    for (size_t g = 0; g < GetFlows (); ++g){
+      for (size_t i = 0; i < HitsFrom (g).size (); ++i){
+        const std::vector<size_t> &next = HitsFrom (HitsFrom (g)[i]);
+        for (size_t k = 0; k < next.size (); ++k){
+          if (next[k] != g){
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  /* Up to maxChains maximal simple paths of minHops to maxHops edges in the
+   * flow hit graph, each listed from the saturating flow to the last victim.
+   * A path is cut at maxHops edges.
+   */
+  std::vector<std::vector<size_t> > CascadeChains (size_t minHops = 2, size_t maxChains = 16, size_t maxHops = 8) const {
+    std::vector<std::vector<size_t> > chains;
+    std::vector<bool> on (GetFlows (), false);
+    for (size_t g = 0; g < GetFlows () && chains.size () < maxChains; ++g){
+      std::vector<size_t> path (1, g);
+      on[g] = true;
+      Extend (path, on, minHops, maxChains, maxHops, chains);
+      on[g] = false;
+    }
+    return chains;
+  }
+
+  // Longest cascade chain in flows hit, 0 if none, at most maxHops.
+  size_t LongestChain (size_t maxHops = 8) const {
+    // bound[d][f]: longest walk of at most d hops from f, never shorter than a simple path
+    std::vector<std::vector<size_t> > bound (maxHops + 1, std::vector<size_t> (GetFlows (), 0));
+    for (size_t d = 1; d <= maxHops; ++d){
+      for (size_t f = 0; f < GetFlows (); ++f){
+        for (size_t i = 0; i < HitsFrom (f).size (); ++i){
+          bound[d][f] = std::max (bound[d][f], 1 + bound[d - 1][HitsFrom (f)[i]]);
+        }
+      }
+    }
+    size_t best = 0;
+    std::vector<bool> on (GetFlows (), false);
+    for (size_t g = 0; g < GetFlows () && best < maxHops; ++g){
+      if (bound[maxHops][g] > best){
+        on[g] = true;
+        Longest (g, 0, maxHops, bound, on, best);
+        on[g] = false;
+      }
+    }
+    return best;
+  }
+
+  std::string Describe () const {
+    std::ostringstream os;
+    std::vector<std::pair<size_t, size_t> > cs = CarrierSenseEdges ();
+    os << "carrier sense:";
+    for (size_t i = 0; i < cs.size (); ++i){
+      os << " " << cs[i].first << (Senses (cs[i].first, cs[i].second) && Senses (cs[i].second, cs[i].first) ? "-" : "~") << cs[i].second;
+    }
+    std::vector<std::pair<size_t, size_t> > hidden = HiddenEdges ();
+    os << "\nhidden terminals:";
+    for (size_t i = 0; i < hidden.size (); ++i){
+      os << " " << hidden[i].first << "->(" << 2 * hidden[i].second << "->" << 2 * hidden[i].second + 1 << ")";
+    }
+    os << "\nundecodable flows:";
+    for (size_t f = 0; f < GetFlows (); ++f){
+      if (!CanDecode (f)){
+        os << " " << 2 * f << "->" << 2 * f + 1;
+      }
+    }
+    const size_t shown = 16;
+    std::vector<std::vector<size_t> > chains = CascadeChains (2, shown + 1);
+    os << "\ncascade chains:";
+    for (size_t i = 0; i < chains.size () && i < shown; ++i){
+      os << (i ? " |" : "");
+      for (size_t k = 0; k < chains[i].size (); ++k){
+        os << (k ? " => " : " ") << 2 * chains[i][k] << "->" << 2 * chains[i][k] + 1;
+      }
+    }
+    if (chains.size () > shown){
+      os << " | ... (first " << shown << " shown), longest " << LongestChain () << " hops";
+    }
+    return os.str ();
+  }
+
+private:
+  void Extend (std::vector<size_t> &path, std::vector<bool> &on, size_t minHops, size_t maxChains, size_t maxHops,
+               std::vector<std::vector<size_t> > &chains) const {
+    bool extended = false;
+    const std::vector<size_t> &next = HitsFrom (path.back ());
+    for (size_t i = 0; i < next.size () && path.size () <= maxHops && chains.size () < maxChains; ++i){
+      size_t f = next[i];
+      if (!on[f]){
+        extended = true;
+        on[f] = true;
+        path.push_back (f);
+        Extend (path, on, minHops, maxChains, maxHops, chains);
+        path.pop_back ();
+        on[f] = false;
+      }
+    }
+    if (!extended && path.size () > minHops && chains.size () < maxChains){
+      chains.push_back (path);
+    }
+  }
+
+  // Depth-first search for a longer simple path, skipping branches the bound rules out.
+  void Longest (size_t f, size_t hops, size_t maxHops, const std::vector<std::vector<size_t> > &bound,
+                std::vector<bool> &on, size_t &best) const {
+    best = std::max (best, hops);
+    const std::vector<size_t> &next = HitsFrom (f);
+    for (size_t i = 0; i < next.size () && best < maxHops; ++i){
+      size_t e = next[i];
+      if (!on[e] && hops + 1 + bound[maxHops - hops - 1][e] > best){
+        on[e] = true;
+        Longest (e, hops + 1, maxHops, bound, on, best);
+        on[e] = false;
+      }
+    }
+  }
+
+  LossMatrix m_loss;
+  LinkBudget m_budget;
+  mutable bool m_graphed;
+  mutable std::vector<std::vector<size_t> > m_hits;  // hit graph, adjacency by hitting flow
+};
+
+#endif /* CDOS_TOPOLOGY_H */